@@ -0,0 +1,155 @@
+#pragma once
+
+//A fixed size bitset with one bit per cell of the board, used to do set operations on many cells at once
+
+#include <stdint.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+//1024 bits covers the padded array needed by size 15, and is exactly four AVX2 registers
+class BitBoard {
+public:
+	static const int words = 16;
+	static const int bits  = words*64;
+
+private:
+	uint64_t w[words];
+
+public:
+	BitBoard() { clear(); }
+
+	void clear(){
+		for(int i = 0; i < words; i++)
+			w[i] = 0;
+	}
+
+	void set(int i)        { w[i >> 6] |=  (1ULL << (i & 63)); }
+	void unset(int i)      { w[i >> 6] &= ~(1ULL << (i & 63)); }
+	bool test(int i) const { return (w[i >> 6] >> (i & 63)) & 1; }
+
+	uint64_t word(int i) const { return w[i]; }
+
+	int count() const {
+		int c = 0;
+		for(int i = 0; i < words; i++)
+			c += __builtin_popcountll(w[i]);
+		return c;
+	}
+
+	//returns the index of the lowest set bit and clears it, -1 if none are set
+	int pop(){
+		for(int i = 0; i < words; i++){
+			if(w[i]){
+				int b = __builtin_ctzll(w[i]);
+				w[i] &= w[i] - 1;
+				return i*64 + b;
+			}
+		}
+		return -1;
+	}
+
+	//index of the lowest set bit at or above i, -1 if none are set
+	int next(int i) const {
+		if(i >= bits)
+			return -1;
+		int k = i >> 6;
+		uint64_t v = w[k] & (~0ULL << (i & 63));
+		while(!v){
+			if(++k >= words)
+				return -1;
+			v = w[k];
+		}
+		return k*64 + __builtin_ctzll(v);
+	}
+
+	//the cells one step away from this set in each of 6 directions, masked by dirs[d] and shifted by shifts[d]
+	//only touches the first W words, so a small board whose cells all fit there pays only for those
+	template<int W> BitBoard spread(const BitBoard * dirs, const int * shifts) const {
+		BitBoard r;
+		for(int d = 0; d < 6; d++){
+			int n = shifts[d];
+			const uint64_t * m = dirs[d].w;
+			if(n > 0){ //0 < n < 64
+				uint64_t carry = 0;
+				for(int i = 0; i < W; i++){
+					uint64_t v = w[i] & m[i];
+					r.w[i] |= (v << n) | carry;
+					carry = v >> (64 - n);
+				}
+			}else{
+				n = -n;
+				uint64_t carry = 0;
+				for(int i = W-1; i >= 0; i--){
+					uint64_t v = w[i] & m[i];
+					r.w[i] |= (v >> n) | carry;
+					carry = v << (64 - n);
+				}
+			}
+		}
+		return r;
+	}
+
+#ifdef __AVX2__
+	//4 words per register
+	static __m256i load(const uint64_t * p){ return _mm256_loadu_si256((const __m256i *)p); }
+	static void store(uint64_t * p, __m256i v){ _mm256_storeu_si256((__m256i *)p, v); }
+
+	bool any() const {
+		__m256i r = load(w);
+		for(int i = 4; i < words; i += 4)
+			r = _mm256_or_si256(r, load(w + i));
+		return !_mm256_testz_si256(r, r);
+	}
+	bool intersects(const BitBoard & o) const {
+		__m256i r = _mm256_and_si256(load(w), load(o.w));
+		for(int i = 4; i < words; i += 4)
+			r = _mm256_or_si256(r, _mm256_and_si256(load(w + i), load(o.w + i)));
+		return !_mm256_testz_si256(r, r);
+	}
+	bool operator == (const BitBoard & o) const {
+		__m256i r = _mm256_xor_si256(load(w), load(o.w));
+		for(int i = 4; i < words; i += 4)
+			r = _mm256_or_si256(r, _mm256_xor_si256(load(w + i), load(o.w + i)));
+		return _mm256_testz_si256(r, r);
+	}
+
+	BitBoard & operator |= (const BitBoard & o){ for(int i = 0; i < words; i += 4) store(w + i, _mm256_or_si256( load(w + i), load(o.w + i))); return *this; }
+	BitBoard & operator &= (const BitBoard & o){ for(int i = 0; i < words; i += 4) store(w + i, _mm256_and_si256(load(w + i), load(o.w + i))); return *this; }
+	BitBoard & operator ^= (const BitBoard & o){ for(int i = 0; i < words; i += 4) store(w + i, _mm256_xor_si256(load(w + i), load(o.w + i))); return *this; }
+	//remove the bits that are set in o, note the argument order of andnot is reversed
+	BitBoard & operator -= (const BitBoard & o){ for(int i = 0; i < words; i += 4) store(w + i, _mm256_andnot_si256(load(o.w + i), load(w + i))); return *this; }
+#else
+	bool any() const {
+		uint64_t r = 0;
+		for(int i = 0; i < words; i++)
+			r |= w[i];
+		return r;
+	}
+	bool intersects(const BitBoard & o) const {
+		uint64_t r = 0;
+		for(int i = 0; i < words; i++)
+			r |= w[i] & o.w[i];
+		return r;
+	}
+	bool operator == (const BitBoard & o) const {
+		uint64_t r = 0;
+		for(int i = 0; i < words; i++)
+			r |= w[i] ^ o.w[i];
+		return !r;
+	}
+
+	BitBoard & operator |= (const BitBoard & o){ for(int i = 0; i < words; i++) w[i] |=  o.w[i]; return *this; }
+	BitBoard & operator &= (const BitBoard & o){ for(int i = 0; i < words; i++) w[i] &=  o.w[i]; return *this; }
+	BitBoard & operator ^= (const BitBoard & o){ for(int i = 0; i < words; i++) w[i] ^=  o.w[i]; return *this; }
+	BitBoard & operator -= (const BitBoard & o){ for(int i = 0; i < words; i++) w[i] &= ~o.w[i]; return *this; }
+#endif
+
+	bool none() const { return !any(); }
+	bool operator != (const BitBoard & o) const { return !(*this == o); }
+
+	BitBoard operator | (const BitBoard & o) const { BitBoard r = *this; r |= o; return r; }
+	BitBoard operator & (const BitBoard & o) const { BitBoard r = *this; r &= o; return r; }
+	BitBoard operator ^ (const BitBoard & o) const { BitBoard r = *this; r ^= o; return r; }
+	BitBoard operator - (const BitBoard & o) const { BitBoard r = *this; r -= o; return r; }
+};
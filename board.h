@@ -6,12 +6,14 @@
 #include <vector>
 #include <string>
 #include <cassert>
+#include <cstring>
 using namespace std;
 
 #include "move.h"
 #include "string.h"
 #include "zobrist.h"
 #include "hashset.h"
+#include "bitboard.h"
 
 static const int BitsSetTable64[] = {
 	0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
@@ -27,6 +29,18 @@ static const int BitsSetTable64[] = {
  * B 3 4 5 => 3 4 5 => 3 4 5
  * C 6 7 8      7 8     7 8
  * This follows the H-Gui convention, not the 'standard' convention
+ *
+ * The array is padded with offboard sentinel cells, 2 rows above and below and 2 columns at
+ * the start of each row that also serve as the end of the row before, so every neighbour of
+ * an onboard cell, out to distance 2, is a fixed offset away and inside the array:
+ *   # # # # #
+ *   # # # # #
+ *   # # 0 1 2
+ *   # # 3 4 5
+ *   # # 6 7 8
+ *   # # # # #
+ *   # # # # # # #
+ * Cells off the hexagon, in the padding or the corners of the square, hold piece 3, same as pattern()
  */
 
 /* neighbours are laid out in this pattern:
@@ -42,11 +56,31 @@ const MoveScore neighbours[18] = {
 	MoveScore(-1,-2, 2), MoveScore(1,-1, 2), MoveScore(2, 1, 2), MoveScore(1, 2, 2), MoveScore(-1, 1, 2), MoveScore(-2,-1, 2), //sides of ring 2, virtual connections
 	};
 
-static MoveValid * staticneighbourlist[11] = {NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL,NULL}; //one per boardsize
+//bitboard masks that only depend on the boardsize
+struct BoardMasks {
+	BitBoard onboard;    //all cells that are part of the hexagon
+	BitBoard edges[6];   //cells on each edge, not including the corners
+	BitBoard corners[6]; //the single cell of each corner
+	BitBoard dirs[6];    //cells that have an onboard neighbour in direction i, used to mask shifts
+	int      offsets[18]; //how far away in the array neighbour i is, also how far to shift a bitboard, + for up, - for down
+	int      words;       //how many bitboard words hold every cell of this boardsize
+	BitBoard * nbs;      //the direct neighbours of each cell
+};
+
+//transforms 0-5 are rotations by 60 degrees, 6-11 are mirrors, which are their own inverse
+const int sym_inverse[12] = {0, 5, 4, 3, 2, 1, 6, 7, 8, 9, 10, 11};
 
 
 class Board{
 public:
+	static const int max_size    = 15;
+	static const int max_vecsize = (2*max_size+3)*(2*max_size+1) + 2; //includes the padding, see the layout above
+	static const int max_cells   = 3*max_size*(max_size-1) + 1;
+	static const int small_size    = 10; //boards up to this size keep their cells inline, bigger ones on the heap
+	static const int small_vecsize = (2*small_size+3)*(2*small_size+1) + 2;
+	static const int small_cells   = 3*small_size*(small_size-1) + 1;
+	static const int unique_depth = 5; //update and test rotations/symmetry with less than this many pieces on the board
+
 	struct Cell {
 /*
 		unsigned piece  : 2; //who controls this cell, 0 for none, 1,2 for players
@@ -61,34 +95,90 @@ public:
 mutable uint16_t parent; //parent for this group of cells
 		uint8_t corner; //which corners are this group connected to
 		uint8_t edge;   //which edges are this group connected to
-		unsigned perm : 4;   //is this a permanent piece or a randomly placed piece?
-		unsigned local: 4;  //0 for far, 1 for distance 2, 2 for virtual connection, 3 for neighbour
+		uint8_t perm : 4;   //is this a permanent piece or a randomly placed piece?
+		uint8_t local: 4;  //0 for far, 1 for distance 2, 2 for virtual connection, 3 for neighbour
 mutable uint8_t ringdepth; //when doing a ring search, what depth was this position found
+		uint16_t pattern; //2 bits per direct neighbour: empty, white, black, offboard. Kept up to date by set/unset
+		uint16_t emptyindex; //position in the list of empty cells, only valid while the cell is empty. Fits in the padding
+		uint16_t next;   //next stone in the same group, a circular list so a group can be walked and two lists spliced in O(1)
 //*/
 
-		Cell() : piece(0), size(0), parent(0), corner(0), edge(0), perm(0), local(0), ringdepth(0) { }
+		Cell() { } //left uninitialized so copying a board doesn't first clear the whole cell array
 		Cell(unsigned int p, unsigned int a, unsigned int s, unsigned int c, unsigned int e, unsigned int l) :
-			piece(p), size(s), parent(a), corner(c), edge(e), perm(0), local(l), ringdepth(0) { }
+			piece(p), size(s), parent(a), corner(c), edge(e), perm(0), local(l), ringdepth(0), pattern(0), emptyindex(0), next(a) { }
 
 		int numcorners() const { return BitsSetTable64[corner]; }
 		int numedges()   const { return BitsSetTable64[edge];   }
 	};
 
+	//records the old value of every cell changed by move, including path compression, so undo can restore it exactly
+	//one log per thread, set on the board it should follow with set_undolog. Copies of the board don't inherit it
+	class UndoLog {
+		friend class Board;
+		struct Entry {
+			uint16_t xy;
+			Cell cell;
+			Entry(int i, const Cell & c) : xy(i), cell(c) { }
+		};
+		struct Frame {
+			Move move;
+			Move last;
+			char outcome;
+			char wintype;
+			unsigned int start; //first entry that belongs to this move
+			Frame(const Move & m, const Move & l, char o, char w, unsigned int s) : move(m), last(l), outcome(o), wintype(w), start(s) { }
+		};
+		vector<Entry> entries;
+		vector<Frame> frames;
+	public:
+		void clear(){
+			entries.clear();
+			frames.clear();
+		}
+		int depth() const { return frames.size(); }
+	};
+
+	//the sets of positions seen by unique MoveIterators, owned by whoever iterates, like a solver or a player thread,
+	//and passed to moveit so the iterator stays small. There is one set per number of moves and side to play,
+	//since nested iterations are always on deeper positions. A swap keeps the move count but changes the side
+	class UniqueSets {
+		friend class Board;
+		HashSet sets[2*unique_depth];
+	};
+
+	//the work done by checkring_df, for a rollout that wants to know what ring checks cost
+	//set on the board it should follow with set_ringstats. Copies of the board don't inherit it
+	struct RingStats {
+		uint64_t calls, steps, maxdepth; //searches, stones visited, longest path followed
+
+		RingStats() { clear(); }
+		void clear(){ calls = steps = maxdepth = 0; }
+		void step(int depth){
+			steps++;
+			if(maxdepth < (uint64_t)depth)
+				maxdepth = depth;
+		}
+		RingStats & operator += (const RingStats & o){
+			calls += o.calls;
+			steps += o.steps;
+			maxdepth = max(maxdepth, o.maxdepth);
+			return *this;
+		}
+	};
+
 	class MoveIterator { //only returns valid moves...
 		const Board & board;
-		int lineend;
+		int next; //index into the board's list of empty cells, so only visits empty cells
 		Move move;
-		bool unique;
-		HashSet hashes;
+		HashSet * hashes; //the positions already returned, NULL when not filtering out symmetric duplicates
 	public:
-		MoveIterator(const Board & b, bool Unique, bool allowswap) : board(b), lineend(0), move(Move(M_SWAP)), unique(Unique) {
+		MoveIterator(const Board & b, HashSet * h, bool allowswap) : board(b), next(0), move(Move(M_SWAP)), hashes(h) {
+			if(hashes)
+				hashes->init(board.movesremain());
+
 			if(board.outcome >= 0){
 				move = Move(0, board.size_d); //already done
 			}else if(!allowswap || !board.valid_move(move)){ //check if swap is valid
-				if(unique){
-					hashes.init(board.movesremain());
-					hashes.add(board.test_hash(move, board.toplay()));
-				}
 				++(*this); //find the first valid move
 			}
 		}
@@ -100,25 +190,17 @@ mutable uint8_t ringdepth; //when doing a ring search, what depth was this posit
 		bool operator != (const Board::MoveIterator & rhs) const { return (move != rhs.move); }
 		MoveIterator & operator ++ (){ //prefix form
 			while(true){
-				do{
-					move.x++;
-
-					if(move.x >= lineend){
-						move.y++;
-						if(move.y >= board.get_size_d()) //done
-							return *this;
-
-						move.x = board.linestart(move.y);
-						lineend = board.lineend(move.y);
-					}
-				}while(!board.valid_move_fast(move));
+				if(next >= board.numempty){
+					move = Move(0, board.size_d); //done
+					return *this;
+				}
+				move = board.xytomove(board.empties[next++]);
 
-				if(unique){
-					uint64_t h = board.test_hash(move, board.toplay());
-					if(hashes.exists(h))
+				if(hashes){
+					hash_t h = board.test_hash(move, board.toplay());
+					if(hashes->exists(h))
 						continue;
-					else
-						hashes.add(board.test_hash(move, board.toplay()));
+					hashes->add(h);
 				}
 				break;
 			}
@@ -136,63 +218,187 @@ private:
 	char size; //the length of one side of the hexagon
 	char sizem1; //size - 1
 	char size_d; //diameter of the board = size*2-1
+	char stride; //length of a row in the padded array = size_d+2
 
 	short num_cells;
 	short nummoves;
-	short unique_depth; //update and test rotations/symmetry with less than this many pieces on the board
+	short numempty;
 	Move last;
 	char toPlay;
 	char outcome; //-3 = unknown, 0 = tie, 1,2 = player win
 	char wintype; //0 no win, 1 = edge, 2 = corner, 3 = ring
 	bool allowswap;
 
-	vector<Cell> cells;
+	BitBoard pieces[2]; //which cells each player owns, kept in sync with cells[].piece
 	Zobrist hash;
-	const MoveValid * neighbourlist;
+	const BoardMasks * masks;
+	const uint16_t * symlist; //symlist[t*vecsize() + i] is where cell i ends up under transform t
+	UndoLog * undolog; //if set, move records its changes so they can be undone
+	RingStats * ringstats; //if set, checkring_df counts its work here
+
+	uint16_t * empties; //dense list of the empty cells, in no particular order, first numempty are valid
+	Cell * cells;
+	//up to small_size the arrays are inline, so copies don't touch the heap and the object stays small.
+	//Bigger boards allocate exactly what they need. Only the first num_cells/vecsize() entries are used
+	//must stay the last members, see copy()
+	uint16_t smallempties[small_cells];
+	Cell smallcells[small_vecsize];
+
+	bool inline_cells() const { return cells == smallcells; }
+
+	//point the arrays at storage for this size
+	void alloc(){
+		if(size <= small_size){
+			empties = smallempties;
+			cells = smallcells;
+		}else{
+			empties = new uint16_t[num_cells];
+			cells = new Cell[vecsize()];
+		}
+	}
+
+	void release(){
+		if(!inline_cells()){
+			delete[] empties;
+			delete[] cells;
+		}
+	}
+
+	//everything before the inline arrays is plain data, so copy it plus the used part of the arrays.
+	//Storage is kept when it's already the right size, so reusing a big board doesn't allocate either
+	void copy(const Board & o){
+		uint16_t * e = empties;
+		Cell * c = cells;
+		if(size != o.size){
+			release();
+			e = NULL;
+		}
+
+		memcpy((void *)this, (const void *)&o, (const char *)o.smallempties - (const char *)&o);
+
+		if(e){
+			empties = e;
+			cells = c;
+		}else{
+			alloc();
+		}
+		memcpy(empties, o.empties, sizeof(uint16_t)*o.num_cells);
+		memcpy(cells, o.cells, sizeof(Cell)*o.vecsize());
+		undolog = NULL;
+		ringstats = NULL;
+	}
+
+	//save the cell before it changes, only while there is a move to undo
+	void log_cell(int i) const {
+		if(undolog && undolog->frames.size())
+			undolog->entries.push_back(UndoLog::Entry(i, cells[i]));
+	}
 
 public:
 	Board(){
 		size = 0;
+		sizem1 = 0;
+		size_d = 0;
+		stride = 0;
+		num_cells = 0;
+		undolog = NULL;
+		ringstats = NULL;
+		alloc();
+	}
+
+	Board(const Board & o){
+		size = 0;
+		alloc();
+		copy(o);
+	}
+
+	~Board(){
+		release();
+	}
+
+	Board & operator = (const Board & o){
+		if(this != & o)
+			copy(o);
+		return *this;
 	}
 
 	Board(int s){
 		size = s;
 		sizem1 = s - 1;
 		size_d = s*2-1;
+		stride = size_d+2;
 		last = M_NONE;
 		nummoves = 0;
-		unique_depth = 5;
 		toPlay = 1;
 		outcome = -3;
 		wintype = 0;
 		allowswap = false;
-		neighbourlist = get_neighbour_list();
-		num_cells = vecsize() - size*sizem1;
+		masks = get_masks();
+		symlist = get_sym_list();
+		undolog = NULL;
+		ringstats = NULL;
+		num_cells = 3*size*sizem1 + 1;
+
+		assert(size <= max_size);
+		assert(xy(size_d-1, size_d-1) < BitBoard::bits);
+
+		alloc();
 
-		cells.resize(vecsize());
+		numempty = 0;
+
+		for(int i = 0; i < vecsize(); i++)
+			cells[i] = Cell(3, i, 1, 0, 0, 0); //offboard sentinel
 
 		for(int y = 0; y < size_d; y++){
-			for(int x = 0; x < size_d; x++){
+			for(int x = linestart(y); x < lineend(y); x++){
 				int i = xy(x, y);
 				cells[i] = Cell(0, i, 1, (1 << iscorner(x, y)), (1 << isedge(x, y)), 0);
+				cells[i].emptyindex = numempty;
+				empties[numempty++] = i;
 			}
 		}
+
+		for(int i = 0; i < vecsize(); i++)
+			if(cells[i].piece == 0)
+				for(int d = 0; d < 6; d++)
+					cells[i].pattern = (cells[i].pattern << 2) | (cells[nb(i, d)].piece == 3 ? 3 : 0);
+
+		symmetry_table(); //build it now, before any threads want it
 	}
 
-	int memsize() const { return sizeof(Board) + sizeof(Cell)*vecsize(); }
+	int memsize() const { return sizeof(Board) + (inline_cells() ? 0 : sizeof(uint16_t)*num_cells + sizeof(Cell)*vecsize()); }
 
 	int get_size_d() const { return size_d; }
 	int get_size() const{ return size; }
 
-	int vecsize() const { return size_d*size_d; }
+	//the size as a compile time constant, S == 0 means only known at runtime
+	//the hot functions below take S so a rollout instantiated per boardsize gets the size folded into xy and onboard
+	template<int S> int get_size()   const { return (S ? S : size); }
+	template<int S> int get_sizem1() const { return (S ? S-1 : sizem1); }
+	template<int S> int get_size_d() const { return (S ? 2*S-1 : size_d); }
+	template<int S> int get_stride() const { return (S ? 2*S+1 : stride); }
+
+	//the whole padded array, sentinels included
+	int vecsize() const { return vecsize<0>(); }
+	template<int S> int vecsize() const { return (get_size_d<S>()+4)*get_stride<S>() + 2; }
 	int numcells() const { return num_cells; }
 
 	int num_moves() const { return nummoves; }
+
+	//the empty cells in no particular order, O(1) access
+	int num_empty() const { return numempty; }
+	int get_empty(int k) const { return empties[k]; }
 	int movesremain() const { return (won() >= 0 ? 0 : num_cells - nummoves + canswap()); }
 
-	int xy(int x, int y)   const { return   y*size_d +   x; }
-	int xy(const Move & m) const { return m.y*size_d + m.x; }
-	int xy(const MoveValid & m) const { return m.xy; }
+	int xy(int x, int y)   const { return xy<0>(x, y); }
+	int xy(const Move & m) const { return xy<0>(m); }
+	template<int S> int xy(int x, int y)   const { return (  y+2)*get_stride<S>() +   x+2; }
+	template<int S> int xy(const Move & m) const { return (m.y+2)*get_stride<S>() + m.x+2; }
+
+	Move xytomove(int i) const { return Move(i % stride - 2, i / stride - 2); }
+
+	//neighbour i of the cell at posxy, always inside the array for an onboard cell, but may be a sentinel
+	int nb(int posxy, int i) const { return posxy + masks->offsets[i]; }
 
 	int xyc(int x, int y)   const { return xy(  x + sizem1,   y + sizem1); }
 	int xyc(const Move & m) const { return xy(m.x + sizem1, m.y + sizem1); }
@@ -200,18 +406,55 @@ public:
 	const Cell * cell(int i)          const { return & cells[i]; }
 	const Cell * cell(int x, int y)   const { return cell(xy(x,y)); }
 	const Cell * cell(const Move & m) const { return cell(xy(m)); }
-	const Cell * cell(const MoveValid & m) const { return cell(m.xy); }
 
 
 	//assumes valid x,y
 	int get(int i)          const { return cells[i].piece; }
 	int get(int x, int y)   const { return get(xy(x,y)); }
 	int get(const Move & m) const { return get(xy(m)); }
-	int get(const MoveValid & m) const { return get(m.xy); }
+	template<int S> int get(const Move & m) const { return get(xy<S>(m)); }
+
+	//bitboard views of the board
+	const BitBoard & get_pieces(int player) const { return pieces[player-1]; }
+	BitBoard empty_cells()                  const { return masks->onboard - pieces[0] - pieces[1]; }
+	const BitBoard & onboard_mask()         const { return masks->onboard; }
+	const BitBoard & edge_mask(int i)       const { return masks->edges[i]; }
+	const BitBoard & corner_mask(int i)     const { return masks->corners[i]; }
+	const BitBoard & nb_mask(int i)         const { return masks->nbs[i]; }
+
+	//how many of the direct neighbours of this cell are owned by player
+	int nb_count(int i, int player) const { return (masks->nbs[i] & pieces[player-1]).count(); }
+
+	//all the cells that neighbour any cell in the set, not including the set itself
+	BitBoard nb_spread(const BitBoard & set) const {
+		switch(masks->words){ //instantiated for the smallest width that holds the board
+			case 1: case 2: case 3: case 4:
+			        return set.spread<4>(masks->dirs, masks->offsets) - set;
+			case 5: case 6: case 7: case 8:
+			        return set.spread<8>(masks->dirs, masks->offsets) - set;
+			default: return set.spread<BitBoard::words>(masks->dirs, masks->offsets) - set;
+		}
+	}
 
-	int geton(const MoveValid & m) const { return (m.onboard() ? get(m.xy) : 0); }
+	//grow the seed to every cell connected to it through passable cells
+	BitBoard flood(BitBoard seed, const BitBoard & passable) const {
+		seed &= passable;
+		BitBoard prev;
+		do{
+			prev = seed;
+			seed |= nb_spread(seed);
+			seed &= passable;
+		}while(seed != prev);
+		return seed;
+	}
+
+	//which cells can player still reach from the given cells without crossing the opponent
+	BitBoard reach(int player, const BitBoard & from) const {
+		return flood(from, masks->onboard - pieces[2-player]);
+	}
 
 	int local(const Move & m, char turn) const { return local(xy(m), turn); }
+	template<int S> int local(const Move & m, char turn) const { return local(xy<S>(m), turn); }
 	int local(int i,          char turn) const {
 		char localshift = (turn & 2); //0 for p1, 2 for p2
 		return ((cells[i].local >> localshift) & 3);
@@ -219,12 +462,14 @@ public:
 
 
 	//assumes x, y are in array bounds
-	bool onboard_fast(int x, int y)   const { return (  y -   x < size) && (  x -   y < size); }
-	bool onboard_fast(const Move & m) const { return (m.y - m.x < size) && (m.x - m.y < size); }
+	bool onboard_fast(int x, int y)   const { return onboard_fast<0>(x, y); }
+	bool onboard_fast(const Move & m) const { return onboard_fast<0>(m.x, m.y); }
+	template<int S> bool onboard_fast(int x, int y) const { return (y - x < get_size<S>()) && (x - y < get_size<S>()); }
 	//checks array bounds too
-	bool onboard(int x, int y)  const { return (  x >= 0 &&   y >= 0 &&   x < size_d &&   y < size_d && onboard_fast(x, y) ); }
-	bool onboard(const Move & m)const { return (m.x >= 0 && m.y >= 0 && m.x < size_d && m.y < size_d && onboard_fast(m) ); }
-	bool onboard(const MoveValid & m) const { return m.onboard(); }
+	bool onboard(int x, int y)  const { return onboard<0>(x, y); }
+	bool onboard(const Move & m)const { return onboard<0>(m.x, m.y); }
+	template<int S> bool onboard(int x, int y)   const { return (x >= 0 && y >= 0 && x < get_size_d<S>() && y < get_size_d<S>() && onboard_fast<S>(x, y)); }
+	template<int S> bool onboard(const Move & m) const { return onboard<S>(m.x, m.y); }
 
 	void setswap(bool s) { allowswap = s; }
 	bool canswap() const { return (nummoves == 1 && toPlay == 2 && allowswap); }
@@ -232,20 +477,11 @@ public:
 	//assumes x, y are in bounds (meaning no swap) and the game isn't already finished
 	bool valid_move_fast(int x, int y)   const { return !get(x,y); }
 	bool valid_move_fast(const Move & m) const { return !get(m); }
+	template<int S> bool valid_move_fast(const Move & m) const { return !get<S>(m); }
 	//checks array bounds too
 	bool valid_move(int x, int y)   const { return (outcome == -3 && onboard(x, y) && !get(x,y)); } //ignores swap rule!
-	bool valid_move(const Move & m) const { return (outcome == -3 && ((onboard(m) && !get(m)) || (m == M_SWAP && canswap()))); }
-
-	//iterator through neighbours of a position
-	const MoveValid * nb_begin(int x, int y)   const { return nb_begin(xy(x, y)); }
-	const MoveValid * nb_begin(const Move & m) const { return nb_begin(xy(m)); }
-	const MoveValid * nb_begin(int i)          const { return &neighbourlist[i*18]; }
-
-	const MoveValid * nb_end(int x, int y)   const { return nb_end(xy(x, y)); }
-	const MoveValid * nb_end(const Move & m) const { return nb_end(xy(m)); }
-	const MoveValid * nb_end(int i)          const { return nb_end(nb_begin(i)); }
-	const MoveValid * nb_end(const MoveValid * m) const { return m + 6; }
-	const MoveValid * nb_endhood(const MoveValid * m) const { return m + 18; }
+	bool valid_move(const Move & m) const { return valid_move<0>(m); }
+	template<int S> bool valid_move(const Move & m) const { return (outcome == -3 && ((onboard<S>(m) && !get<S>(m)) || (m == M_SWAP && canswap()))); }
 
 	int iscorner(int x, int y) const {
 		if(!onboard(x,y))
@@ -279,28 +515,77 @@ public:
 		return -1;
 	}
 
-	MoveValid * get_neighbour_list(){
-		if(!staticneighbourlist[(int)size]){
-			MoveValid * list = new MoveValid[vecsize()*18];
-			MoveValid * a = list;
+	BoardMasks * get_masks(){
+		static BoardMasks * staticmasklist[max_size+1] = {NULL}; //one per boardsize
+		if(!staticmasklist[(int)size]){
+			BoardMasks * m = new BoardMasks();
+			m->nbs = new BitBoard[vecsize()];
+
+			for(int d = 0; d < 18; d++)
+				m->offsets[d] = neighbours[d].y*stride + neighbours[d].x;
+			m->words = xy(size_d-1, size_d-1)/64 + 1;
+
 			for(int y = 0; y < size_d; y++){
 				for(int x = 0; x < size_d; x++){
-					Move pos(x,y);
+					if(!onboard(x, y))
+						continue;
 
-					for(int i = 0; i < 18; i++){
-						Move loc = pos + neighbours[i];
-						*a = MoveValid(loc, (onboard(loc) ? xy(loc) : -1) );
-						++a;
+					int i = xy(x, y);
+					m->onboard.set(i);
+
+					if(iscorner(x, y) >= 0) m->corners[iscorner(x, y)].set(i);
+					if(isedge(x, y)   >= 0) m->edges[isedge(x, y)].set(i);
+
+					for(int d = 0; d < 6; d++){
+						Move loc = Move(x, y) + neighbours[d];
+						if(onboard(loc)){
+							m->dirs[d].set(i);
+							m->nbs[i].set(xy(loc));
+						}
 					}
 				}
 			}
 
-			staticneighbourlist[(int)size] = list;
+			staticmasklist[(int)size] = m;
 		}
 
-		return staticneighbourlist[(int)size];
+		return staticmasklist[(int)size];
 	}
 
+	//where each cell lands under each of the 12 rotations/mirrors, so hashing doesn't redo the coordinate math
+	uint16_t * get_sym_list(){
+		static uint16_t * staticsymlist[max_size+1] = {NULL}; //12 transforms per cell, one per boardsize
+		if(!staticsymlist[(int)size]){
+			int vs = vecsize();
+			uint16_t * list = new uint16_t[12*vs];
+			for(int i = 0; i < 12*vs; i++) //offboard cells are never looked up, but keep them a valid index
+				list[i] = i % vs;
+			for(int y = 0; y < size_d; y++){
+				for(int x = linestart(y); x < lineend(y); x++){
+					int i = xy(x, y);
+
+					//mirror is simply flip x,y
+					int a = x - sizem1,
+					    b = y - sizem1,
+					    c = b - a;
+
+//x,y; y,z; z,-x; -x,-y; -y,-z; -z,x
+//y,x; z,y; -x,z; -y,-x; -z,-y; x,-z
+
+					int r[12] = {
+						xyc( a,  b), xyc( b,  c), xyc( c, -a), xyc(-a, -b), xyc(-b, -c), xyc(-c,  a),
+						xyc( b,  a), xyc( c,  b), xyc(-a,  c), xyc(-b, -a), xyc(-c, -b), xyc( a, -c),
+					};
+					for(int t = 0; t < 12; t++)
+						list[t*vs + i] = r[t];
+				}
+			}
+
+			staticsymlist[(int)size] = list;
+		}
+
+		return staticsymlist[(int)size];
+	}
 
 	int linestart(int y) const { return (y < size ? 0 : y - sizem1); }
 	int lineend(int y)   const { return (y < size ? size + y : size_d); }
@@ -328,8 +613,9 @@ public:
 		s += "\n";
 
 		for(int y = 0; y < size_d; y++){
-			s += string(abs(sizem1 - y) + 2, ' ');
-			s += coord + char('A' + y);
+			string row = Move::row_str(y, true);
+			s += string(abs(sizem1 - y) + 3 - row.size(), ' '); //two letter rows stick out to the left
+			s += coord + row;
 			int end = lineend(y);
 			for(int x = linestart(y); x < end; x++){
 				s += (last == Move(x, y)   ? coord + "[" :
@@ -401,27 +687,111 @@ public:
 		return toPlay;
 	}
 
-	MoveIterator moveit(bool unique = false, int swap = -1) const {
-		return MoveIterator(*this, (unique ? nummoves <= unique_depth : false), (swap == -1 ? allowswap : swap));
+	//with unique, skip moves that give the same position as an earlier one by symmetry, which only happens in the first unique_depth moves
+	MoveIterator moveit(UniqueSets * unique = NULL, int swap = -1) const {
+		HashSet * h = (unique && nummoves < unique_depth ? &unique->sets[2*nummoves + toPlay - 1] : NULL);
+		return MoveIterator(*this, h, (swap == -1 ? allowswap : swap));
 	}
 
-	void set(const Move & m, bool perm = true){
+	void set(const Move & m, bool perm = true){ set<0, true>(m, perm); }
+	template<int S> void set(const Move & m, bool perm = true){ set<S, true>(m, perm); }
+	//full == false skips the hash and perm flag, for boards that are only played out, see move_rollout
+	template<int S, bool full> void set(const Move & m, bool perm = true){
+		int i = xy<S>(m);
 		last = m;
-		Cell * cell = & cells[xy(m)];
+		Cell * cell = & cells[i];
 		cell->piece = toPlay;
-		cell->perm = perm;
+		if(full)
+			cell->perm = perm;
+		pieces[toPlay-1].set(i);
+		set_pattern_slot(i, toPlay);
+		remove_empty(i);
 		nummoves++;
-		update_hash(m, toPlay); //depends on nummoves
+		if(full)
+			update_hash<S>(m, toPlay); //depends on nummoves
 		toPlay = 3 - toPlay;
 	}
 
-	void unset(const Move & m){ //break win checks, but is a poor mans undo if all you care about is the hash
+	void unset(const Move & m){ //break win checks, but is a poor mans undo if all you care about is the hash, see undo for a full undo
 		toPlay = 3 - toPlay;
 		update_hash(m, toPlay);
 		nummoves--;
 		Cell * cell = & cells[xy(m)];
 		cell->piece = 0;
 		cell->perm = 0;
+		pieces[toPlay-1].unset(xy(m));
+		set_pattern_slot(xy(m), 0);
+		add_empty(xy(m));
+	}
+
+	//swap with the last empty cell and shrink. The filled cell remembers where it was,
+	//so adding cells back in reverse order restores the exact order, which keeps MoveIterators valid across move/undo
+	void remove_empty(int i){
+		int k = cells[i].emptyindex;
+		int last = empties[--numempty];
+		empties[k] = last;
+		cells[last].emptyindex = k;
+		empties[numempty] = i;
+	}
+	void add_empty(int i){
+		int k = cells[i].emptyindex;
+		if(k < numempty && empties[k] == i) //already empty
+			return;
+		if(k < numempty){ //move whatever took its place back to the end
+			int last = empties[k];
+			empties[numempty] = last;
+			cells[last].emptyindex = numempty;
+			empties[k] = i;
+		}else{
+			cells[i].emptyindex = k = numempty;
+			empties[k] = i;
+		}
+		numempty++;
+	}
+
+	//the only stone goes back to player 1
+	void undoswap(){
+		int i = pieces[1].next(0);
+		cells[i].piece = 1;
+		pieces[1].unset(i);
+		pieces[0].set(i);
+		set_pattern_slot(i, 1);
+		toPlay = 2;
+	}
+
+	//undo the last move made while an undo log was set, restoring the exact state from before it
+	bool undo(){
+		if(!undolog || undolog->frames.empty())
+			return false;
+
+		UndoLog::Frame f = undolog->frames.back();
+		undolog->frames.pop_back();
+
+		while(undolog->entries.size() > f.start){
+			const UndoLog::Entry & e = undolog->entries.back();
+			cells[e.xy] = e.cell;
+			undolog->entries.pop_back();
+		}
+
+		if(f.move == M_SWAP)
+			undoswap();
+		else
+			unset(f.move);
+
+		last = f.last;
+		outcome = f.outcome;
+		wintype = f.wintype;
+		return true;
+	}
+
+	void set_undolog(UndoLog * log){ undolog = log; }
+	void set_ringstats(RingStats * r){ ringstats = r; }
+
+	void set_local(int i, int bits){
+		if((cells[i].local | bits) != cells[i].local){ //most are already set, so avoid logging them
+			log_cell(i);
+			cells[i].local |= bits;
+		}
 	}
 
 	void doswap(){
@@ -429,6 +799,9 @@ public:
 			for(int x = linestart(y); x < lineend(y); x++){
 				if(get(x,y) != 0){
 					cells[xy(x,y)].piece = 2;
+					pieces[0].unset(xy(x,y));
+					pieces[1].set(xy(x,y));
+					set_pattern_slot(xy(x,y), 2);
 					toPlay = 1;
 					return;
 				}
@@ -436,7 +809,6 @@ public:
 		}
 	}
 
-	int find_group(const MoveValid & m) const { return find_group(m.xy); }
 	int find_group(const Move & m) const { return find_group(xy(m)); }
 	int find_group(int x, int y)   const { return find_group(xy(x, y)); }
 	int find_group(unsigned int i) const {
@@ -445,7 +817,10 @@ public:
 			do{
 				p = cells[p].parent;
 			}while(p != cells[p].parent);
-			cells[i].parent = p; //do path compression, but only the current one, not all, to avoid recursion
+			if(cells[i].parent != p){
+				log_cell(i);
+				cells[i].parent = p; //do path compression, but only the current one, not all, to avoid recursion
+			}
 		}
 		return p;
 	}
@@ -464,22 +839,48 @@ public:
 		if(cells[i].size < cells[j].size) //force i's subtree to be bigger
 			swap(i, j);
 
+		log_cell(i);
+		log_cell(j);
 		cells[j].parent = i;
-		cells[i].size   += cells[j].size;
+		cells[i].size    = min(255, cells[i].size + cells[j].size); //saturate, only ever compared against small sizes
 		cells[i].corner |= cells[j].corner;
 		cells[i].edge   |= cells[j].edge;
+		swap(cells[i].next, cells[j].next); //splice the two member lists into one
 
 		return false;
 	}
 
+	//every stone in the group that i is part of, by walking its member list
+	BitBoard group_cells(int i) const {
+		BitBoard g;
+		int j = i;
+		do{
+			g.set(j);
+			j = cells[j].next;
+		}while(j != i);
+		return g;
+	}
+
+	//the frontier of the group that i is part of: the empty cells next to any of its stones, including ones in pockets
+	BitBoard liberties(int i) const {
+		BitBoard l;
+		int j = i;
+		do{
+			l |= masks->nbs[j];
+			j = cells[j].next;
+		}while(j != i);
+		return l - pieces[0] - pieces[1];
+	}
+
 	Cell test_cell(const Move & pos) const {
 		char turn = toplay();
 		int posxy = xy(pos);
 
 		Cell testcell = cells[find_group(pos)];
-		for(const MoveValid * i = nb_begin(posxy), *e = nb_end(i); i < e; i++){
-			if(i->onboard() && turn == get(i->xy)){
-				const Cell * g = & cells[find_group(i->xy)];
+		for(int i = 0; i < 6; i++){
+			int n = nb(posxy, i);
+			if(turn == get(n)){
+				const Cell * g = & cells[find_group(n)];
 				testcell.corner |= g->corner;
 				testcell.edge   |= g->edge;
 				testcell.size   += g->size; //not quite accurate if it's joining the same group twice
@@ -509,11 +910,11 @@ public:
 		if(g->piece == otherplayer && (g->edge || g->corner))
 			return false;
 
-		for(const MoveValid * i = nb_begin(posxy), *e = nb_end(i); i < e; i++){
-			if(!i->onboard())
+		for(int i = 0; i < 6; i++){
+			const Cell * g = & cells[find_group(nb(posxy, i))];
+			if(g->piece == 3) //next to the edge of the board
 				return false;
 
-			const Cell * g = & cells[find_group(i->xy)];
 			if(g->piece == otherplayer && (g->edge || g->corner))
 				return false;
 		}
@@ -527,18 +928,20 @@ public:
 	// can be done before or after placing the stone and joining neighbouring groups
 	// using a ringsize smaller than a previous ring check could lead to weird results
 	bool checkring_df(const Move & pos, const int turn, const int ringsize = 6, const int permsneeded = 0) const {
-		const Cell * start = & cells[xy(pos)];
+		return checkring_df<0>(pos, turn, ringsize, permsneeded);
+	}
+	template<int S> bool checkring_df(const Move & pos, const int turn, const int ringsize = 6, const int permsneeded = 0) const {
+		int posxy = xy<S>(pos);
+		const Cell * start = & cells[posxy];
 		start->ringdepth = 1;
+		if(ringstats)
+			ringstats->calls++;
 		bool success = false;
 		for(int i = 0; i < 4; i++){ //4 instead of 6 since any ring must have its first endpoint in the first 4
-			Move loc = pos + neighbours[i];
+			int loc = nb(posxy, i);
+			const Cell * g = & cells[loc];
 
-			if(!onboard(loc))
-				continue;
-
-			const Cell * g = & cells[xy(loc)];
-
-			if(turn != g->piece)
+			if(turn != g->piece) //sentinels never match
 				continue;
 
 			g->ringdepth = 2;
@@ -553,23 +956,21 @@ public:
 	}
 	// only take the 3 directions that are valid in a ring
 	// the backwards directions are either invalid or not part of the shortest loop
-	bool followring(const Move & cur, const int & dir, const int & turn, const int & depth, const int & ringsize, const int & permsneeded) const {
+	bool followring(int cur, const int & dir, const int & turn, const int & depth, const int & ringsize, const int & permsneeded) const {
 		for(int i = 5; i <= 7; i++){
 			int nd = (dir + i) % 6;
-			Move next = cur + neighbours[nd];
-
-			if(!onboard(next))
-				continue;
-
-			const Cell * g = & cells[xy(next)];
+			int next = nb(cur, nd);
+			const Cell * g = & cells[next];
 
-			if(g->ringdepth)
+			if(g->ringdepth) //only ever set on stones, never on sentinels
 				return (depth - g->ringdepth >= ringsize && permsneeded <= 0);
 
 			if(turn != g->piece)
 				continue;
 
 			g->ringdepth = depth;
+			if(ringstats)
+				ringstats->step(depth);
 			bool success = followring(next, nd, turn, depth+1, ringsize, (permsneeded - g->perm));
 			g->ringdepth = 0;
 
@@ -579,9 +980,12 @@ public:
 		return false;
 	}
 
-	// do an O(1) ring check
+	// do an O(1) ring check, finds the same rings as checkring_df with the default ringsize and no perms
+	// a ring either joins a group to itself around a cell that isn't its own, or surrounds one of its own stones
 	// must be done before placing the stone and joining it with the neighbouring groups
-	bool checkring_o1(const Move & pos, const int turn) const {
+	bool checkring_o1(const Move & pos, const int turn) const { return checkring_o1(xy(pos), turn); }
+	template<int S> bool checkring_o1(const Move & pos, const int turn) const { return checkring_o1(xy<S>(pos), turn); }
+	bool checkring_o1(int posxy, const int turn) const {
 		static const unsigned char ringdata[64][10] = {
 			{0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, //000000
 			{0, 0, 0, 0, 0, 0, 0, 0, 0, 0}, //000001
@@ -650,12 +1054,8 @@ public:
 		};
 
 		int bitpattern = 0;
-		const MoveValid * s = nb_begin(pos);
-		for(const MoveValid * i = s, *e = nb_end(i); i < e; i++){
-			bitpattern <<= 1;
-			if(i->onboard() && turn == get(i->xy))
-				bitpattern |= 1;
-		}
+		for(int i = 0; i < 6; i++)
+			bitpattern = (bitpattern << 1) | (turn == get(nb(posxy, i)));
 
 		const unsigned char * d = ringdata[bitpattern];
 
@@ -664,29 +1064,29 @@ public:
 				return false;
 
 			case 1: //simple case (000101, 001101, 001011, 011011)
-				return (find_group(s[d[1]]) == find_group(s[d[2]]));
+				return (find_group(nb(posxy, d[1])) == find_group(nb(posxy, d[2])));
 
 			case 2:{ //3 non-neighbours (010101)
-				int a = find_group(s[d[1]]), b = find_group(s[d[2]]), c = find_group(s[d[3]]);
+				int a = find_group(nb(posxy, d[1])), b = find_group(nb(posxy, d[2])), c = find_group(nb(posxy, d[3]));
 				return (a == b || a == c || b == c);
 			}
 
 			case 7: //case 1 and 3 (010111)
-				if(find_group(s[d[4]]) == find_group(s[d[5]]))
+				if(find_group(nb(posxy, d[4])) == find_group(nb(posxy, d[5])))
 					return true;
 				//fall through
 
 			case 3: // 3 neighbours (000111)
-				return checkring_back(s[d[1]], s[d[2]], s[d[3]], turn);
+				return checkring_back(posxy, d + 1, turn);
 
 			case 4: // 4 neighbours (001111)
-				return checkring_back(s[d[1]], s[d[2]], s[d[3]], turn) ||
-				       checkring_back(s[d[4]], s[d[5]], s[d[6]], turn);
+				return checkring_back(posxy, d + 1, turn) ||
+				       checkring_back(posxy, d + 4, turn);
 
 			case 5: // 5 neighbours (011111)
-				return checkring_back(s[d[1]], s[d[2]], s[d[3]], turn) ||
-				       checkring_back(s[d[4]], s[d[5]], s[d[6]], turn) ||
-				       checkring_back(s[d[7]], s[d[8]], s[d[9]], turn);
+				return checkring_back(posxy, d + 1, turn) ||
+				       checkring_back(posxy, d + 4, turn) ||
+				       checkring_back(posxy, d + 7, turn);
 
 			case 6: // 6 neighbours (111111)
 				return true; //a ring around this position? how'd that happen
@@ -695,15 +1095,21 @@ public:
 				return false;
 		}
 	}
-	//checks for 3 more stones, a should be the corner
-	bool checkring_back(const MoveValid & a, const MoveValid & b, const MoveValid & c, int turn) const {
-		return (a.onboard() && get(a) == turn && get(b) == turn && get(c) == turn);
+	//checks for 3 more stones around posxy, the first of the 3 neighbours should be the corner
+	bool checkring_back(int posxy, const unsigned char * d, int turn) const {
+		return (get(nb(posxy, d[0])) == turn && get(nb(posxy, d[1])) == turn && get(nb(posxy, d[2])) == turn);
 	}
 
 	hash_t gethash() const {
 		return (nummoves > unique_depth ? hash.get(0) : hash.get());
 	}
 
+	//also returns which transform gave the canonical hash, 0 once symmetry is no longer tracked
+	hash_t gethash(int & transform) const {
+		transform = 0;
+		return (nummoves > unique_depth ? hash.get(0) : hash.get_min(transform));
+	}
+
 	string hashstr() const {
 		static const char hexlookup[] = "0123456789abcdef";
 		char buf[19] = "0x";
@@ -716,32 +1122,31 @@ public:
 		return (char *)buf;
 	}
 
-	void update_hash(const Move & pos, int turn){
+	//where a cell on this board is in the position as seen through transform t
+	int sym_xy(int i, int t) const { return symlist[t*vecsize() + i]; }
+
+	Move sym_move(const Move & m, int t) const {
+		if(m.y < 0) //swap, none, etc
+			return m;
+		return xytomove(sym_xy(xy(m), t));
+	}
+
+	//translate moves between this board and the canonical orientation given by gethash(transform) or test_hash
+	//use these to store moves with a canonical hash and bring them back on a mirror image position
+	Move to_canonical(const Move & m, int transform)   const { return sym_move(m, transform); }
+	Move from_canonical(const Move & m, int transform) const { return sym_move(m, sym_inverse[transform]); }
+
+	void update_hash(const Move & pos, int turn){ update_hash<0>(pos, turn); }
+	template<int S> void update_hash(const Move & pos, int turn){
+		int i = xy<S>(pos);
 		if(nummoves > unique_depth){ //simple update, no rotations/symmetry
-			hash.update(0, 3*xy(pos) + turn);
+			hash.update(0, 3*i + turn);
 			return;
 		}
 
-		//mirror is simply flip x,y
-		int x = pos.x - sizem1,
-		    y = pos.y - sizem1,
-		    z = y - x;
-
-//x,y; y,z; z,-x; -x,-y; -y,-z; -z,x
-//y,x; z,y; -x,z; -y,-x; -z,-y; x,-z
-
-		hash.update(0,  3*xyc( x,  y) + turn);
-		hash.update(1,  3*xyc( y,  z) + turn);
-		hash.update(2,  3*xyc( z, -x) + turn);
-		hash.update(3,  3*xyc(-x, -y) + turn);
-		hash.update(4,  3*xyc(-y, -z) + turn);
-		hash.update(5,  3*xyc(-z,  x) + turn);
-		hash.update(6,  3*xyc( y,  x) + turn);
-		hash.update(7,  3*xyc( z,  y) + turn);
-		hash.update(8,  3*xyc(-x,  z) + turn);
-		hash.update(9,  3*xyc(-y, -x) + turn);
-		hash.update(10, 3*xyc(-z, -y) + turn);
-		hash.update(11, 3*xyc( x, -z) + turn);
+		int vs = vecsize<S>();
+		for(int t = 0; t < 12; t++)
+			hash.update(t, 3*symlist[t*vs + i] + turn);
 	}
 
 	hash_t test_hash(const Move & pos) const {
@@ -749,42 +1154,61 @@ public:
 	}
 
 	hash_t test_hash(const Move & pos, int turn) const {
-		if(nummoves >= unique_depth) //simple test, no rotations/symmetry
-			return hash.test(0, 3*xy(pos) + turn);
-
-		int x = pos.x - sizem1,
-		    y = pos.y - sizem1,
-		    z = y - x;
-
-		hash_t m = hash.test(0,  3*xyc( x,  y) + turn);
-		m = min(m, hash.test(1,  3*xyc( y,  z) + turn));
-		m = min(m, hash.test(2,  3*xyc( z, -x) + turn));
-		m = min(m, hash.test(3,  3*xyc(-x, -y) + turn));
-		m = min(m, hash.test(4,  3*xyc(-y, -z) + turn));
-		m = min(m, hash.test(5,  3*xyc(-z,  x) + turn));
-		m = min(m, hash.test(6,  3*xyc( y,  x) + turn));
-		m = min(m, hash.test(7,  3*xyc( z,  y) + turn));
-		m = min(m, hash.test(8,  3*xyc(-x,  z) + turn));
-		m = min(m, hash.test(9,  3*xyc(-y, -x) + turn));
-		m = min(m, hash.test(10, 3*xyc(-z, -y) + turn));
-		m = min(m, hash.test(11, 3*xyc( x, -z) + turn));
+		int transform;
+		return test_hash(pos, turn, transform);
+	}
+
+	//the hash after pos is played, and which transform gave it
+	hash_t test_hash(const Move & pos, int turn, int & transform) const {
+		int i = xy(pos);
+		transform = 0;
+		if(nummoves >= unique_depth || pos.y < 0) //simple test, no rotations/symmetry, or swap which has no cell to transform
+			return hash.test(0, 3*i + turn);
+
+		int vs = vecsize();
+		hash_t m = hash.test(0, 3*i + turn);
+		for(int t = 1; t < 12; t++){
+			hash_t h = hash.test(t, 3*symlist[t*vs + i] + turn);
+			if(m > h){
+				m = h;
+				transform = t;
+			}
+		}
 		return m;
 	}
 
 	unsigned int sympattern(const Move & pos) const { return sympattern(xy(pos)); }
-	unsigned int sympattern(int posxy)        const { return pattern_symmetry(pattern(posxy)); }
+	unsigned int sympattern(int posxy)        const { return symmetry_table()[pattern(posxy)]; }
 
+	//the pattern is maintained incrementally, so this is a single load
 	unsigned int pattern(const Move & pos) const { return pattern(xy(pos)); }
-	unsigned int pattern(int posxy)        const {
-		unsigned int p = 0;
-		for(const MoveValid * i = nb_begin(posxy), *e = nb_end(i); i < e; i++){
-			p <<= 2;
-			if(i->onboard())
-				p |= cells[i->xy].piece;
-			else
-				p |= 3;
+	unsigned int pattern(int posxy)        const { return cells[posxy].pattern; }
+
+	//which direct neighbours are turn's, read from the pattern: bit 2k is set if the neighbour in slot k is, neighbour i is in slot 5-i
+	unsigned int own_nbs(int posxy, int turn) const {
+		unsigned int p = cells[posxy].pattern ^ (turn * 0x555);
+		return ~(p | (p >> 1)) & 0x555;
+	}
+
+	//a stone changed at posxy, so update its slot in each neighbour's pattern, O(6)
+	void set_pattern_slot(int posxy, int piece){
+		static const int shift[6] = {4, 2, 0, 10, 8, 6}; //neighbour i sees this cell in direction (i+3)%6
+		for(int i = 0; i < 6; i++){ //sentinels get a pattern too, but it's never read
+			Cell * c = & cells[nb(posxy, i)];
+			c->pattern = (c->pattern & ~(3 << shift[i])) | (piece << shift[i]);
 		}
-		return p;
+	}
+
+	//pattern_symmetry for all 4096 patterns, computed once
+	static const uint16_t * symmetry_table(){
+		static uint16_t * table = NULL;
+		if(!table){
+			uint16_t * t = new uint16_t[4096];
+			for(unsigned int p = 0; p < 4096; p++)
+				t[p] = pattern_symmetry(p);
+			table = t;
+		}
+		return table;
 	}
 
 	static unsigned int pattern_invert(unsigned int p){ //switch players
@@ -814,11 +1238,28 @@ public:
 	}
 
 	bool move(const Move & pos, bool checkwin = true, bool locality = false, int ringsize = 6, int permring = 0){
+		return move<0>(pos, checkwin, locality, ringsize, permring);
+	}
+	template<int S> bool move(const Move & pos, bool checkwin = true, bool locality = false, int ringsize = 6, int permring = 0){
+		return move<S, true>(pos, checkwin, locality, ringsize, permring);
+	}
+
+	//move for a board that is only played out to the end and thrown away, like a rollout copy
+	//skips the hash, local bits, perm flags and undo log, keeping only what finding the winner needs
+	//afterwards gethash() and local() are stale and the moves can't be undone
+	template<int S> bool move_rollout(const Move & pos, int ringsize = 6, int permring = 0){
+		return move<S, false>(pos, true, false, ringsize, permring);
+	}
+
+	template<int S, bool full> bool move(const Move & pos, bool checkwin, bool locality, int ringsize, int permring){
 		assert(outcome < 0);
 
-		if(!valid_move(pos))
+		if(!valid_move<S>(pos))
 			return false;
 
+		if(full && undolog)
+			undolog->frames.push_back(UndoLog::Frame(pos, last, outcome, wintype, undolog->entries.size()));
+
 		if(pos == M_SWAP){
 			doswap();
 			return true;
@@ -827,28 +1268,28 @@ public:
 		char turn = toplay();
 		char localshift = (turn & 2); //0 for p1, 2 for p2
 
-		set(pos, !permring);
+		//a plain ring check is O(1) but must happen before the stone is placed, other sizes need the search afterwards
+		bool fastring = (ringsize <= 6 && permring == 0);
+		bool ring = (checkwin && ringsize && fastring && own_nbs(xy<S>(pos), turn) && checkring_o1<S>(pos, turn));
 
-		if(locality){
-			for(int i = 6; i < 18; i++){
-				MoveScore loc = neighbours[i] + pos;
+		set<S, full>(pos, !permring);
 
-				if(onboard(loc))
-					cells[xy(loc)].local |= (loc.score << localshift);
-			}
-		}
+		int posxy = xy<S>(pos);
 
-		int posxy = xy(pos);
-		bool islocal = (local(pos, turn) == 3);
+		if(full && locality) //sentinels get marked too, but are never read
+			for(int i = 6; i < 18; i++)
+				set_local(nb(posxy, i), neighbours[i].score << localshift);
+
+		bool islocal = own_nbs(posxy, turn);
 		bool alreadyjoined = false; //useful for finding rings
-		for(const MoveValid * i = nb_begin(posxy), *e = nb_end(i); i < e; i++){
-			if(i->onboard()){
-				cells[i->xy].local |= (3 << localshift);
-				if(islocal && turn == get(i->xy)){
-					alreadyjoined |= join_groups(posxy, i->xy);
-					i++; //skip the next one. If it is the same group,
-						 //it is already connected and forms a corner, which we can ignore
-				}
+		for(int i = 0; i < 6; i++){
+			int n = nb(posxy, i);
+			if(full)
+				set_local(n, 3 << localshift);
+			if(islocal && turn == get(n)){
+				alreadyjoined |= join_groups(posxy, n);
+				i++; //skip the next one. If it is the same group,
+					 //it is already connected and forms a corner, which we can ignore
 			}
 		}
 
@@ -860,7 +1301,7 @@ public:
 			}else if(g->numcorners() >= 2){
 				outcome = turn;
 				wintype = 2;
-			}else if(ringsize && alreadyjoined && g->size >= max(6, ringsize) && checkring_df(pos, turn, ringsize, permring)){
+			}else if(ring || (ringsize && !fastring && alreadyjoined && g->size >= max(6, ringsize) && checkring_df<S>(pos, turn, ringsize, permring))){
 				outcome = turn;
 				wintype = 3;
 			}else if(nummoves == num_cells){
@@ -876,32 +1317,71 @@ public:
 
 	//test if making this move would win, but don't actually make the move
 	int test_win(const Move & pos, char turn = 0, bool checkrings = true) const {
+		return test_win<0>(pos, turn, checkrings);
+	}
+	template<int S> int test_win(const Move & pos, char turn = 0, bool checkrings = true) const {
 		if(turn == 0)
 			turn = toplay();
 
-		if(test_local(pos, turn)){
-			int posxy = xy(pos);
-			Cell testcell = cells[find_group(posxy)];
-			int numgroups = 0;
-			for(const MoveValid * i = nb_begin(posxy), *e = nb_end(i); i < e; i++){
-				if(i->onboard() && turn == get(i->xy)){
-					const Cell * g = & cells[find_group(i->xy)];
-					testcell.corner |= g->corner;
-					testcell.edge   |= g->edge;
-					testcell.size   += g->size;
-					i++; //skip the next one
-					numgroups++;
-				}
-			}
+		if(wins_at(xy<S>(pos), turn, checkrings))
+			return turn;
 
-			if(testcell.numcorners() >= 2 || testcell.numedges() >= 3 || (checkrings && numgroups >= 2 && testcell.size >= 6 && checkring_o1(pos, turn)))
-				return turn;
-		}
+		if(nummoves+1 == num_cells)
+			return 0;
+
+		return -3;
+	}
+
+	//test_win given the winning_cells mask for turn, so a loop over moves doesn't redo the group lookups
+	int test_win(const Move & pos, char turn, const BitBoard & wins) const {
+		if(pos.y >= 0 && wins.test(xy(pos))) //swap never wins
+			return turn;
 
 		if(nummoves+1 == num_cells)
 			return 0;
 
 		return -3;
 	}
+
+	//would placing a stone for turn on the empty cell posxy win by fork, bridge or ring
+	//reads which neighbours are turn's from the pattern and looks up one group per run of them
+	bool wins_at(int posxy, char turn, bool checkrings = true) const {
+		unsigned int own = own_nbs(posxy, turn);
+		if(!own)
+			return false;
+
+		if(own == 0x555) //surrounded, a ring around this cell
+			if(checkrings)
+				return true;
+
+		unsigned int starts = own & ~(((own >> 2) | (own << 10)) & 0x555); //first of each run, the previous neighbour is one slot up
+		if(!starts)
+			starts = 1;
+
+		const Cell * c = & cells[find_group(posxy)];
+		unsigned int corner = c->corner, edge = c->edge, size = c->size;
+		for(unsigned int b = starts; b; b &= b - 1){
+			const Cell * g = & cells[find_group(nb(posxy, 5 - (__builtin_ctz(b) >> 1)))];
+			corner |= g->corner;
+			edge   |= g->edge;
+			size   += g->size;
+		}
+
+		return (BitsSetTable64[corner] >= 2 || BitsSetTable64[edge] >= 3 || (checkrings && size >= 6 && __builtin_popcount(own) >= 2 && checkring_o1(posxy, turn)));
+	}
+
+	//every empty cell where a stone for turn would win immediately, by fork, bridge or ring
+	//only cells next to one of turn's stones can win, so this is one pass over the frontier of turn's groups
+	BitBoard winning_cells(char turn, bool checkrings = true) const {
+		BitBoard wins;
+		if(outcome >= 0)
+			return wins;
+
+		BitBoard frontier = nb_spread(pieces[turn-1]) - pieces[2-turn];
+		for(int i = frontier.pop(); i >= 0; i = frontier.pop())
+			if(wins_at(i, turn, checkrings))
+				wins.set(i);
+		return wins;
+	}
 };
 
@@ -0,0 +1,191 @@
+
+#pragma once
+
+//The stats of a node's unsolved children in parallel arrays, so choose_move can score them 8 at a time with AVX2
+//and pick the best with a vector argmax. Without AVX2 it falls back to a plain loop over the same arrays.
+//Both compute exactly what Node::value plus the UCT term would, in the same order, so the choices don't change.
+
+#include <vector>
+#include <cmath>
+#include <cassert>
+#include <stdint.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+template <class T> class ChildScores {
+	//the raw counts, converted to float 8 at a time instead of one by one while gathering
+	std::vector<uint32_t> expsum, expnum, ravesum, ravenum; //sums are in ExpPair points, 2 per win, 1 per tie
+	std::vector<int32_t>  know;
+	std::vector<T *>      items; //what each entry was gathered from
+
+#ifdef __AVX2__
+	static __m256i load(const uint32_t * p){ return _mm256_loadu_si256((const __m256i *)p); }
+
+	//exactly (float)u for unsigned u: both halves convert exactly, so the add is the only rounding
+	static __m256 to_float(__m256i u){
+		__m256 hi = _mm256_cvtepi32_ps(_mm256_srli_epi32(u, 16));
+		__m256 lo = _mm256_cvtepi32_ps(_mm256_and_si256(u, _mm256_set1_epi32(0xFFFF)));
+		return _mm256_add_ps(_mm256_mul_ps(hi, _mm256_set1_ps(65536.0f)), lo);
+	}
+#endif
+
+public:
+	//what choose_move scores with, the same for all the children of a node
+	struct Params {
+		float ravefactor; //rave is ignored if this is <= Player::min_rave
+		bool  userave;
+		bool  knowledge;
+		float fpurgency;
+		float explore;    //no exploration term if <= 0
+		float logvisits;
+	};
+
+	//appends children through its own copies of the array pointers, which stay in registers while gathering,
+	//where stores through the vectors would make the compiler reload them after every one
+	class Gather {
+		uint32_t * expsum, * expnum, * ravesum, * ravenum;
+		int32_t  * know;
+		T       ** items;
+		int num, cap;
+		friend class ChildScores;
+	public:
+		void add(T * item, uint32_t es, uint32_t en, uint32_t rs, uint32_t rn, int k){
+			assert(num < cap);
+			items[num]   = item;
+			expsum[num]  = es;
+			expnum[num]  = en;
+			ravesum[num] = rs;
+			ravenum[num] = rn;
+			know[num]    = k;
+			num++;
+		}
+	};
+
+	//room for n children, rounded up to a whole register
+	void resize(int n){
+		n = (n + 7) & ~7;
+		expsum.resize(n);
+		expnum.resize(n);
+		ravesum.resize(n);
+		ravenum.resize(n);
+		know.resize(n);
+		items.resize(n);
+	}
+
+	//start over with no children, add them with the Gather, then pass it to best
+	Gather gather(){
+		Gather g;
+		g.expsum  = &expsum[0];
+		g.expnum  = &expnum[0];
+		g.ravesum = &ravesum[0];
+		g.ravenum = &ravenum[0];
+		g.know    = &know[0];
+		g.items   = &items[0];
+		g.num = 0;
+		g.cap = items.size();
+		return g;
+	}
+
+	//the first child with the highest score and that score, NULL if there are no children
+	T * best(const Gather & g, const Params & p, float & val) const {
+		int num = g.num;
+		if(num == 0)
+			return NULL;
+#ifdef __AVX2__
+		const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f), half = _mm256_set1_ps(0.5f);
+		const __m256 hundredth = _mm256_set1_ps(0.01f), thousand = _mm256_set1_ps(1000.0f), eight = _mm256_set1_ps(8.0f);
+		const __m256 rf = _mm256_set1_ps(p.ravefactor), fpu = _mm256_set1_ps(p.fpurgency);
+		const __m256 explore = _mm256_set1_ps(p.explore), logvisits = _mm256_set1_ps(p.logvisits);
+		const __m256 end = _mm256_set1_ps(num), ninf = _mm256_set1_ps(-INFINITY);
+
+		__m256 idx = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+		__m256 bestval = ninf, bestidx = zero;
+
+		for(int i = 0; i < num; i += 8){
+			__m256i expn = load(&expnum[i]);
+			__m256 en = to_float(expn);
+			__m256 hasexp = _mm256_cmp_ps(en, zero, _CMP_GT_OQ);
+			__m256 expavg = _mm256_div_ps(_mm256_mul_ps(half, to_float(load(&expsum[i]))), en);
+			__m256 v;
+
+			if(p.userave){
+				__m256 rn = to_float(load(&ravenum[i]));
+				__m256 hasrave = _mm256_cmp_ps(rn, zero, _CMP_GT_OQ);
+				__m256 raveavg = _mm256_div_ps(_mm256_mul_ps(half, to_float(load(&ravesum[i]))), rn);
+				__m256 alpha = _mm256_div_ps(rf, _mm256_add_ps(rf, en));
+
+				v = _mm256_and_ps(hasrave, _mm256_mul_ps(alpha, raveavg));
+				v = _mm256_add_ps(v, _mm256_and_ps(hasexp, _mm256_mul_ps(_mm256_sub_ps(one, alpha), expavg)));
+				v = _mm256_blendv_ps(fpu, v, _mm256_or_ps(hasrave, hasexp));
+			}else{
+				v = _mm256_blendv_ps(fpu, expavg, hasexp);
+			}
+
+			if(p.knowledge){
+				__m256 k = _mm256_mul_ps(hundredth, _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *)&know[i])));
+				__m256 kv = _mm256_blendv_ps(_mm256_div_ps(k, _mm256_sqrt_ps(en)), k, _mm256_cmp_ps(en, one, _CMP_LE_OQ));
+				__m256 use = _mm256_and_ps(_mm256_cmp_ps(k, zero, _CMP_GT_OQ), _mm256_cmp_ps(en, thousand, _CMP_LT_OQ));
+				v = _mm256_add_ps(v, _mm256_and_ps(use, kv));
+			}
+
+			if(p.explore > 0)
+				v = _mm256_add_ps(v, _mm256_mul_ps(explore, _mm256_sqrt_ps(_mm256_div_ps(logvisits, to_float(_mm256_add_epi32(expn, _mm256_set1_epi32(1)))))));
+
+			//the padding past the last child never wins, and each lane only takes strictly better, so it keeps its first best
+			v = _mm256_blendv_ps(ninf, v, _mm256_cmp_ps(idx, end, _CMP_LT_OQ));
+			__m256 better = _mm256_cmp_ps(v, bestval, _CMP_GT_OQ);
+			bestval = _mm256_blendv_ps(bestval, v, better);
+			bestidx = _mm256_blendv_ps(bestidx, idx, better);
+			idx = _mm256_add_ps(idx, eight);
+		}
+
+		//the highest value across the lanes, then the lowest index with it
+		float vals[8], idxs[8];
+		_mm256_storeu_ps(vals, bestval);
+		_mm256_storeu_ps(idxs, bestidx);
+		int ret = -1;
+		val = -INFINITY;
+		for(int l = 0; l < 8; l++){
+			if(vals[l] > val || (vals[l] == val && vals[l] > -INFINITY && (int)idxs[l] < ret)){
+				val = vals[l];
+				ret = (int)idxs[l];
+			}
+		}
+		return (ret >= 0 ? items[ret] : NULL);
+#else
+		int ret = -1;
+		val = -INFINITY;
+		for(int i = 0; i < num; i++){
+			float en = expnum[i], rn = ravenum[i], k = know[i], v = p.fpurgency;
+
+			if(!p.userave){
+				if(en > 0)
+					v = 0.5f*expsum[i]/en;
+			}else if(rn > 0 || en > 0){
+				float alpha = p.ravefactor/(p.ravefactor + en);
+				v = 0;
+				if(rn > 0) v += alpha*(0.5f*ravesum[i]/rn);
+				if(en > 0) v += (1.0f-alpha)*(0.5f*expsum[i]/en);
+			}
+
+			if(p.knowledge && k > 0){
+				if(en <= 1)
+					v += 0.01f * k;
+				else if(en < 1000)
+					v += 0.01f * k / std::sqrt(en);
+			}
+
+			if(p.explore > 0)
+				v += p.explore*std::sqrt(p.logvisits/(expnum[i] + 1));
+
+			if(val < v){
+				val = v;
+				ret = i;
+			}
+		}
+		return (ret >= 0 ? items[ret] : NULL);
+#endif
+	}
+};
+
@@ -17,7 +17,7 @@
  */
 template <class Node> class CompactTree {
 	static const unsigned int CHUNK_SIZE = 16*1024*1024;
-	static const unsigned int MAX_NUM = 300; //maximum amount of Node's to allocate at once, needed for size of freelist
+	static const unsigned int MAX_NUM = 640; //maximum amount of Node's to allocate at once, needed for size of freelist. More than the 631 cells of a size 15 board
 
 	//Hold a list of children within the compact tree
 	struct Data {
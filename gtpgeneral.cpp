@@ -1,6 +1,10 @@
 
 #include "havannahgtp.h"
 #include "lbdist.h"
+#include "positioncode.h"
+#include "weightedrandtree.h"
+#include "weightedrandbuckets.h"
+#include "xorshift.h"
 
 GTPResponse HavannahGTP::gtp_echo(vecstr args){
 	return GTPResponse(true, implode(args, " "));
@@ -48,7 +52,7 @@ GTPResponse HavannahGTP::gtp_boardsize(vecstr args){
 	log("boardsize " + args[0]);
 
 	int size = from_str<int>(args[0]);
-	if(size < 3 || size > 10)
+	if(size < 3 || size > Board::max_size)
 		return GTPResponse(false, "Size " + to_str(size) + " is out of range.");
 
 	game = HavannahGame(size);
@@ -106,9 +110,7 @@ GTPResponse HavannahGTP::gtp_patterns(vecstr args){
 	Board board = game.getboard();
 	for(Board::MoveIterator move = board.moveit(); !move.done(); ++move){
 		ret += move->to_s() + " ";
-		unsigned int p = board.pattern(*move);
-		if(symmetric)
-			p = board.pattern_symmetry(p);
+		unsigned int p = (symmetric ? board.sympattern(*move) : board.pattern(*move));
 		if(invert && board.toplay() == 2)
 			p = board.pattern_invert(p);
 		ret += to_str(p);
@@ -117,9 +119,26 @@ GTPResponse HavannahGTP::gtp_patterns(vecstr args){
 	return GTPResponse(true, ret);
 }
 
+//the feature indexes on one line, then the chance the side to move wins on the next if weights are loaded
+GTPResponse HavannahGTP::gtp_features(vecstr args){
+	Board board = game.getboard();
+	LBDists dists;
+
+	vector<int> f = player.valuefunc.features(board, dists);
+	string ret;
+	for(unsigned int i = 0; i < f.size(); i++)
+		ret += (i ? " " : "") + to_str(f[i]);
+
+	if(player.valuefunc.is_loaded())
+		ret += "\n" + to_str(player.valuefunc.eval(board, dists), 4);
+
+	return GTPResponse(true, ret);
+}
+
 GTPResponse HavannahGTP::gtp_all_legal(vecstr args){
 	string ret;
-	for(Board::MoveIterator move = game.getboard().moveit(); !move.done(); ++move)
+	Board board = game.getboard(); //the iterator refers to it, so it has to outlive the loop
+	for(Board::MoveIterator move = board.moveit(); !move.done(); ++move)
 		ret += move_str(*move) + " ";
 	return GTPResponse(true, ret);
 }
@@ -248,6 +267,89 @@ GTPResponse HavannahGTP::gtp_debug(vecstr args){
 	return GTPResponse(true, str);
 }
 
+//time how long it takes to copy a half full board of each size
+GTPResponse HavannahGTP::gtp_bench_copy(vecstr args){
+	int iters = 1000000;
+	if(args.size() >= 1)
+		iters = from_str<int>(args[0]);
+
+	string ret = "\n";
+	for(int size = 3; size <= Board::max_size; size++){
+		Board board(size);
+		for(int i = 0; board.num_moves() < board.numcells()/2; i++)
+			if(board.valid_move(board.xytomove(i)))
+				board.move(board.xytomove(i), false);
+
+		Board copy;
+		int sum = 0;
+		Time start;
+		for(int i = 0; i < iters; i++){
+			copy = board;
+			sum += copy.num_moves(); //use the copy so it isn't optimized away
+		}
+		double t = Time() - start;
+
+		ret += "size " + to_str(size) + ": " + to_str(t*1000000000/iters, 1) + " ns per copy (" + to_str(sum/iters) + " moves)\n";
+	}
+	return GTPResponse(true, ret);
+}
+
+//play games the way a weighted rollout uses its sampler: fill every cell, then pick a cell, zero it
+//and reweight its 6 neighbours until none are left. Returns the time per move in ns
+template<class W> static double bench_sampler(const Board & board, int games, const float * gammas){
+	W w[2];
+	XORShift_uint32 rand32;
+	Time start;
+	int moves = 0;
+	for(int g = 0; g < games; g++){
+		for(int p = 0; p < 2; p++){
+			w[p].resize(board.vecsize());
+			for(Board::MoveIterator m = board.moveit(NULL, false); !m.done(); ++m)
+				w[p].set_weight_fast(board.xy(*m), gammas[rand32() % 4096]);
+			w[p].rebuild_tree();
+		}
+
+		for(int turn = 0; w[turn].sum_weight() > 0; turn = 1 - turn, moves++){
+			int j = w[turn].choose();
+			w[0].set_weight(j, 0);
+			w[1].set_weight(j, 0);
+			for(int i = 0; i < 6; i++){
+				int n = board.nb(j, i);
+				if(board.onboard(board.xytomove(n)) && w[0].get_weight(n) > 0){
+					w[0].set_weight(n, gammas[rand32() % 4096]);
+					w[1].set_weight(n, gammas[rand32() % 4096]);
+				}
+			}
+		}
+	}
+	return (Time() - start)*1000000000/moves;
+}
+
+GTPResponse HavannahGTP::gtp_bench_weighted(vecstr args){
+	int games = 1000;
+	if(args.size() >= 1)
+		games = from_str<int>(args[0]);
+
+	//the loaded gammas if any, otherwise a spread like trained ones have
+	bool loaded = false;
+	for(int i = 0; i < 4096; i++)
+		loaded |= (player.gammas[i] != 1);
+
+	float gammas[4096];
+	XORShift_float unitrand;
+	for(int i = 0; i < 4096; i++)
+		gammas[i] = (loaded ? player.gammas[i] : std::exp(8*unitrand() - 4));
+
+	string ret = "\n";
+	for(int size = 4; size <= Board::max_size; size++){
+		Board board(size);
+		double tree    = bench_sampler<WeightedRandTree>(board, games, gammas);
+		double buckets = bench_sampler<WeightedRandBuckets>(board, games, gammas);
+		ret += "size " + to_str(size) + ": tree " + to_str(tree, 1) + " ns, buckets " + to_str(buckets, 1) + " ns per move\n";
+	}
+	return GTPResponse(true, ret);
+}
+
 GTPResponse HavannahGTP::gtp_dists(vecstr args){
 	Board board = game.getboard();
 	LBDists dists(&board);
@@ -279,8 +381,9 @@ GTPResponse HavannahGTP::gtp_dists(vecstr args){
 	}
 
 	for(int y = 0; y < size_d; y++){
-		s += string(abs(size-1 - y) + 2, ' ');
-		s += char('A' + y);
+		string row = Move::row_str(y, true);
+		s += string(abs(size-1 - y) + 3 - row.size(), ' ');
+		s += row;
 		for(int x = board.linestart(y); x < board.lineend(y); x++){
 			int p = board.get(x, y);
 			s += ' ';
@@ -307,3 +410,29 @@ GTPResponse HavannahGTP::gtp_zobrist(vecstr args){
 	return GTPResponse(true, game.getboard().hashstr());
 }
 
+GTPResponse HavannahGTP::gtp_poscode(vecstr args){
+	if(args.size() == 0)
+		return GTPResponse(true, PositionCode::canonical(game.getboard()).to_s());
+
+	PositionCode code;
+	if(!code.from_s(args[0]))
+		return GTPResponse(false, "Invalid position code");
+
+	HavannahGame g(code.size());
+	vector<Move> moves = code.moves();
+	for(unsigned int i = 0; i < moves.size(); i++){
+		if(moves[i] == M_SWAP) //the game history is replayed with swap off, so it can't hold one
+			return GTPResponse(false, "poscode doesn't support positions after a swap");
+		if(!g.move(moves[i]))
+			return GTPResponse(false, "This position can't be reached by playing its stones in order");
+	}
+
+	game = g;
+	set_board();
+
+	time_remain = time.game;
+
+	log("poscode " + args[0]);
+	return GTPResponse(true);
+}
+
@@ -168,8 +168,8 @@ GTPResponse HavannahGTP::gtp_player_solve(vecstr args){
 		if(player.profile)
 			stats += "Times:       " + to_str(times[0], 3) + ", " + to_str(times[1], 3) + ", " + to_str(times[2], 3) + ", " + to_str(times[3], 3) + "\n";
 		stats += "Win Types:   ";
-		stats += "P1: f " + to_str(wintypes[0][1].num) + ", b " + to_str(wintypes[0][2].num) + ", r " + to_str(wintypes[0][3].num) + "; ";
-		stats += "P2: f " + to_str(wintypes[1][1].num) + ", b " + to_str(wintypes[1][2].num) + ", r " + to_str(wintypes[1][3].num) + "\n";
+		stats += "P1: f " + to_str(wintypes[0][1].num) + ", b " + to_str(wintypes[0][2].num) + ", r " + to_str(wintypes[0][3].num) + (player.truncate ? ", t " + to_str(wintypes[0][0].num) : string()) + "; ";
+		stats += "P2: f " + to_str(wintypes[1][1].num) + ", b " + to_str(wintypes[1][2].num) + ", r " + to_str(wintypes[1][3].num) + (player.truncate ? ", t " + to_str(wintypes[1][0].num) : string()) + "\n";
 
 		if(verbose >= 2){
 			stats += "P1 fork:     " + wintypes[0][1].to_s() + "\n";
@@ -455,8 +455,8 @@ GTPResponse HavannahGTP::gtp_genmove(vecstr args){
 		if(player.profile)
 			stats += "Times:       " + to_str(times[0], 3) + ", " + to_str(times[1], 3) + ", " + to_str(times[2], 3) + ", " + to_str(times[3], 3) + "\n";
 		stats += "Win Types:   ";
-		stats += "W: f " + to_str(wintypes[0][1].num*100.0/games,0) + "%, b " + to_str(wintypes[0][2].num*100.0/games,0) + "%, r " + to_str(wintypes[0][3].num*100.0/games,0) + "%; ";
-		stats += "B: f " + to_str(wintypes[1][1].num*100.0/games,0) + "%, b " + to_str(wintypes[1][2].num*100.0/games,0) + "%, r " + to_str(wintypes[1][3].num*100.0/games,0) + "%\n";
+		stats += "W: f " + to_str(wintypes[0][1].num*100.0/games,0) + "%, b " + to_str(wintypes[0][2].num*100.0/games,0) + "%, r " + to_str(wintypes[0][3].num*100.0/games,0) + "%" + (player.truncate ? ", t " + to_str(wintypes[0][0].num*100.0/games,0) + "%" : string()) + "; ";
+		stats += "B: f " + to_str(wintypes[1][1].num*100.0/games,0) + "%, b " + to_str(wintypes[1][2].num*100.0/games,0) + "%, r " + to_str(wintypes[1][3].num*100.0/games,0) + "%" + (player.truncate ? ", t " + to_str(wintypes[1][0].num*100.0/games,0) + "%" : string()) + "\n";
 
 		if(verbose >= 2){
 			stats += "W fork:     " + wintypes[0][1].to_s() + "\n";
@@ -516,6 +516,64 @@ GTPResponse HavannahGTP::gtp_genmove(vecstr args){
 	return GTPResponse(true, move_str(best) + extended);
 }
 
+//sum the counters over the threads and start them over
+GTPResponse HavannahGTP::gtp_rollout_counters(vecstr args){
+	player.stop_threads(); //stop pondering so no thread counts while they're read and cleared
+
+	RolloutCounters counters;
+	for(unsigned int i = 0; i < player.threads.size(); i++){
+		counters += player.threads[i]->counters;
+		player.threads[i]->counters.clear();
+	}
+
+	if(player.ponder && player.root.outcome < 0)
+		player.start_threads();
+
+	string ret = counters.to_s();
+	if(!player.rolloutcount)
+		ret += "\nCounting is off, turn it on with: player_params --counters 1";
+	return GTPResponse(true, "\n" + ret);
+}
+
+//grow the tree from the current position, then report how much tree fits in memory and how fast choose_move walks it
+GTPResponse HavannahGTP::gtp_bench_tree(vecstr args){
+	int runs = 100000, passes = 10, depth = 1000;
+	if(args.size() >= 1)
+		runs = from_str<int>(args[0]);
+	if(args.size() >= 2)
+		passes = from_str<int>(args[1]);
+	if(args.size() >= 3)
+		depth = from_str<int>(args[2]);
+
+	if(player.rootboard.won() >= 0 || runs <= 0 || passes <= 0 || depth <= 0)
+		return GTPResponse(false, "Needs a game in progress and positive arguments");
+
+	player.rootboard.setswap(allow_swap);
+
+	Time start;
+	player.genmove(0, runs, false);
+	double searchtime = Time() - start;
+
+	player.stop_threads(); //stop pondering so the tree holds still
+
+	uint64_t mem = player.ctmem.meminuse();
+	uint64_t calls, children;
+	Player::PlayerUCT * thread = (Player::PlayerUCT *) player.threads[0];
+	double ns = thread->bench_choose_move(&player.root, player.rootboard.toplay(), player.rootboard.movesremain(), depth, passes, calls, children);
+
+	if(player.ponder && player.root.outcome < 0)
+		player.start_threads();
+
+	string ret = "\n";
+	ret += "node: " + to_str(sizeof(Player::Node)) + " bytes, " + to_str(player.nodes) + " nodes in " + to_str(mem/(1024.0*1024.0), 1) + " Mb, " +
+	       (player.nodes ? to_str((double)mem/player.nodes, 1) : string("-")) + " bytes per node with the child list headers\n";
+	ret += "nodes per Gb: " + (mem ? to_str(1024.0*player.nodes/mem, 2) : string("-")) + " million\n";
+	ret += "search: " + to_str(player.runs) + " runs in " + to_str(searchtime, 2) + " s, " + to_str(player.runs/searchtime, 0) + " runs/s\n";
+	ret += "choose_move: " + to_str(calls) + " calls, " + to_str(ns, 1) + " ns per call, " +
+	       (children ? to_str(ns*calls/children, 2) : string("-")) + " ns per child, " + to_str(children/(ns*calls/1000.0), 1) + " M children/s";
+	return GTPResponse(true, ret);
+}
+
 GTPResponse HavannahGTP::gtp_player_params(vecstr args){
 	if(args.size() == 0)
 		return GTPResponse(true, string("\n") +
@@ -527,6 +585,7 @@ GTPResponse HavannahGTP::gtp_player_params(vecstr args){
 			"  -o --ponder      Continue to ponder during the opponents time      [" + to_str(player.ponder) + "]\n" +
 			"  -M --maxmem      Max memory in Mb to use for the tree              [" + to_str(player.maxmem/(1024*1024)) + "]\n" +
 			"     --profile     Output the time used by each phase of MCTS        [" + to_str(player.profile) + "]\n" +
+			"     --counters    Count rollout feature costs, see rollout_counters [" + to_str(player.rolloutcount) + "]\n" +
 			"Final move selection:\n" +
 			"  -E --msexplore   Lower bound constant in final move selection      [" + to_str(player.msexplore) + "]\n" +
 			"  -F --msrave      Rave factor, 0 for pure exp, -1 # sims, -2 # wins [" + to_str(player.msrave) + "]\n" +
@@ -540,6 +599,7 @@ GTPResponse HavannahGTP::gtp_player_params(vecstr args){
 			"  -X --useexplore  Use exploration with this probability [0-1]       [" + to_str(player.useexplore) + "]\n" +
 			"  -u --fpurgency   Value to assign to an unplayed move               [" + to_str(player.fpurgency) + "]\n" +
 			"  -O --rollouts    Number of rollouts to run per simulation          [" + to_str(player.rollouts) + "]\n" +
+			"  -v --usevalue    Score leaves by the value function, prob [0-1]    [" + to_str(player.usevalue) + "]\n" +
 			"  -I --dynwiden    Dynamic widening, consider log_wid(exp) children  [" + to_str(player.dynwiden) + "]\n" +
 			"Tree building:\n" +
 			"  -s --shortrave   Only use moves from short rollouts for rave       [" + to_str(player.shortrave) + "]\n" +
@@ -558,7 +618,7 @@ GTPResponse HavannahGTP::gtp_player_params(vecstr args){
 			"  -b --bridge         to maintaining a 2-bridge after the op probes  [" + to_str(player.bridge) + "]\n" +
 			"  -D --distance       to low minimum distance to win (<0 avoid VCs)  [" + to_str(player.dists) + "]\n" +
 			"Rollout policy:\n" +
-			"  -h --weightrand  Weight the moves according to computed gammas     [" + to_str(player.weightedrandom) + "]\n" +
+			"  -h --weightrand  Weight by gammas: 1 or true tree, 2 O(1) buckets  [" + to_str(player.weightedrandom) + "]\n" +
 			"  -C --checkrings  Check for rings only this often in rollouts       [" + to_str(player.checkrings) + "]\n" +
 			"  -R --ringdepth   Check for rings for this depth, < 0 for % moves   [" + to_str(player.checkringdepth) + "]\n" +
 			"  -Z --ringsize    Starting minimum ring size in rollouts            [" + to_str(player.minringsize) + "]\n" +
@@ -567,7 +627,9 @@ GTPResponse HavannahGTP::gtp_player_params(vecstr args){
 			"  -p --pattern     Maintain the virtual connection pattern           [" + to_str(player.rolloutpattern) + "]\n" +
 			"  -g --goodreply   Reuse the last good reply (1), remove losses (2)  [" + to_str(player.lastgoodreply) + "]\n" +
 			"  -w --instantwin  Look for instant wins (1) and forced replies (2)  [" + to_str(player.instantwin) + "]\n" +
-			"  -W --instwindep  How deep to check instant wins, - multiplies size [" + to_str(player.instwindepth) + "]\n"
+			"  -W --instwindep  How deep to check instant wins, - multiplies size [" + to_str(player.instwindepth) + "]\n" +
+			"  -K --truncate    Score rollouts by distance to win after K moves   [" + to_str(player.truncate) + "]\n" +
+			"  -V --truncmargin Only if one side is this many stones closer       [" + to_str(player.truncmargin) + "]\n"
 			);
 
 	string errs;
@@ -584,6 +646,8 @@ GTPResponse HavannahGTP::gtp_player_params(vecstr args){
 			player.set_ponder(from_str<bool>(args[++i]));
 		}else if((arg == "--profile") && i+1 < args.size()){
 			player.profile = from_str<bool>(args[++i]);
+		}else if((arg == "--counters") && i+1 < args.size()){
+			player.rolloutcount = from_str<bool>(args[++i]);
 		}else if((arg == "-M" || arg == "--maxmem") && i+1 < args.size()){
 			player.maxmem = from_str<uint64_t>(args[++i])*1024*1024;
 		}else if((arg == "-E" || arg == "--msexplore") && i+1 < args.size()){
@@ -621,6 +685,8 @@ GTPResponse HavannahGTP::gtp_player_params(vecstr args){
 			player.useexplore = from_str<float>(args[++i]);
 		}else if((arg == "-u" || arg == "--fpurgency") && i+1 < args.size()){
 			player.fpurgency = from_str<float>(args[++i]);
+		}else if((arg == "-v" || arg == "--usevalue") && i+1 < args.size()){
+			player.usevalue = from_str<float>(args[++i]);
 		}else if((arg == "-O" || arg == "--rollouts") && i+1 < args.size()){
 			player.rollouts = from_str<int>(args[++i]);
 			if(player.gclimit < player.rollouts*5)
@@ -643,7 +709,10 @@ GTPResponse HavannahGTP::gtp_player_params(vecstr args){
 		}else if((arg == "-D" || arg == "--distance") && i+1 < args.size()){
 			player.dists = from_str<int>(args[++i]);
 		}else if((arg == "-h" || arg == "--weightrand") && i+1 < args.size()){
-			player.weightedrandom = from_str<bool>(args[++i]);
+			string val = args[++i];
+			int w = (val == "true" ? 1 : val == "false" ? 0 : from_str<int>(val)); //it used to be a bool
+			if(w < 0 || w > 2) return GTPResponse(false, "Weighted random must be 0, 1 or 2");
+			player.weightedrandom = w;
 		}else if((arg == "-C" || arg == "--checkrings") && i+1 < args.size()){
 			player.checkrings = from_str<float>(args[++i]);
 		}else if((arg == "-R" || arg == "--ringdepth") && i+1 < args.size()){
@@ -662,6 +731,10 @@ GTPResponse HavannahGTP::gtp_player_params(vecstr args){
 			player.instantwin = from_str<int>(args[++i]);
 		}else if((arg == "-W" || arg == "--instwindep") && i+1 < args.size()){
 			player.instwindepth = from_str<int>(args[++i]);
+		}else if((arg == "-K" || arg == "--truncate") && i+1 < args.size()){
+			player.truncate = from_str<int>(args[++i]);
+		}else if((arg == "-V" || arg == "--truncmargin") && i+1 < args.size()){
+			player.truncmargin = from_str<int>(args[++i]);
 		}else{
 			return GTPResponse(false, "Missing or unknown parameter");
 		}
@@ -701,6 +774,17 @@ GTPResponse HavannahGTP::gtp_player_gammas(vecstr args){
 	return GTPResponse(true);
 }
 
+GTPResponse HavannahGTP::gtp_player_values(vecstr args){
+	if(args.size() == 0)
+		return GTPResponse(true, "Must pass the filename of a set of value function weights");
+
+	string err = player.valuefunc.load(args[0]);
+	if(err != "")
+		return GTPResponse(false, err);
+
+	return GTPResponse(true);
+}
+
 GTPResponse HavannahGTP::gtp_confirm_proof(vecstr args){
 	Time start;
 
@@ -73,7 +73,8 @@ GTPResponse HavannahGTP::gtp_solve_ab_stats(vecstr args){
 		board.move(Move(args[i]));
 
 	int value;
-	for(Board::MoveIterator move = board.moveit(true); !move.done(); ++move){
+	Board::UniqueSets unique;
+	for(Board::MoveIterator move = board.moveit(&unique); !move.done(); ++move){
 		value = solverab.tt_get(board.test_hash(*move));
 
 		s += move->to_s() + "," + to_str(value) + "\n";
@@ -276,6 +277,8 @@ GTPResponse HavannahGTP::gtp_solve_pnstt(vecstr args){
 	solverpnstt.solve(time);
 
 	logerr("Finished in " + to_str(solverpnstt.time_used*1000, 0) + " msec\n");
+	if(solverpnstt.verify)
+		logerr("Hash collisions caught: " + to_str(solverpnstt.collisions) + "\n");
 
 	return GTPResponse(true, solve_str(solverpnstt));
 }
@@ -292,6 +295,7 @@ GTPResponse HavannahGTP::gtp_solve_pnstt_params(vecstr args){
 			"  -e --epsilon  How big should the threshold be                          [" + to_str(solverpnstt.epsilon) + "]\n"
 			"  -a --abdepth  Run an alpha-beta search of this size at each leaf       [" + to_str(solverpnstt.ab) + "]\n"
 			"  -c --copy     Try to copy a proof to this many siblings, <0 quit early [" + to_str(solverpnstt.copyproof) + "]\n"
+			"  -v --verify   Check TT hits against the exact position, costs memory   [" + to_str(solverpnstt.verify) + "]\n"
 //			"  -l --lbdist   Initialize with the lower bound on distance to win       [" + to_str(solverpnstt.lbdist) + "]\n"
 			);
 
@@ -313,6 +317,8 @@ GTPResponse HavannahGTP::gtp_solve_pnstt_params(vecstr args){
 			solverpnstt.ab = from_str<int>(args[++i]);
 		}else if((arg == "-c" || arg == "--copy") && i+1 < args.size()){
 			solverpnstt.copyproof = from_str<int>(args[++i]);
+		}else if((arg == "-v" || arg == "--verify") && i+1 < args.size()){
+			solverpnstt.set_verify(from_str<bool>(args[++i]));
 //		}else if((arg == "-l" || arg == "--lbdist") && i+1 < args.size()){
 //			solverpnstt.lbdist = from_str<bool>(args[++i]);
 		}else{
@@ -331,7 +337,8 @@ GTPResponse HavannahGTP::gtp_solve_pnstt_stats(vecstr args){
 		board.move(Move(args[i]));
 
 	SolverPNSTT::PNSNode * child = NULL;
-	for(Board::MoveIterator move = board.moveit(true); !move.done(); ++move){
+	Board::UniqueSets unique;
+	for(Board::MoveIterator move = board.moveit(&unique); !move.done(); ++move){
 		child = solverpnstt.tt(board, *move);
 
 		s += move->to_s() + "," + to_str(child->phi) + "," + to_str(child->delta) + "\n";
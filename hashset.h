@@ -1,39 +1,48 @@
 
 #pragma once
 
+#include <vector>
 #include "zobrist.h"
 
+//A set of hashes that is emptied by bumping a generation stamp instead of clearing the table,
+//so one can be reused at every solver node without allocating or touching the whole table.
+//The table only grows, so it allocates until it has reached the biggest size asked for
 class HashSet {
-	unsigned int size;
 	unsigned int mask;
-	hash_t * table;
+	unsigned int gen;
+	std::vector<hash_t> table;
+	std::vector<unsigned int> stamp; //an entry is only in the set if its stamp is gen
 
 public:
-	HashSet() : size(0), mask(0), table(NULL) { }
-	HashSet(unsigned int s){ init(s); }
-	~HashSet(){
-		if(table)
-			delete[] table;
-		table = NULL;
-	}
+	HashSet() : mask(0), gen(0) { }
+	HashSet(unsigned int s) : mask(0), gen(0) { init(s); }
 
+	//empty the set, with room for s hashes
 	void init(unsigned int s){
-		size = roundup(s)*4;
+		unsigned int size = roundup(s)*4;
+		if(table.size() < size){
+			table.resize(size);
+			stamp.assign(size, 0);
+			gen = 0;
+		}
 		mask = size-1;
-		table = new hash_t[size];
-		for(unsigned int i = 0; i < size; i++)
-			table[i] = 0;
+
+		if(++gen == 0){ //wrapped, so old stamps could look current
+			std::fill(stamp.begin(), stamp.end(), 0);
+			gen = 1;
+		}
 	}
 
 	void add(hash_t h){
 		unsigned int i = h & mask;
-		while(table[i] != 0)
+		while(stamp[i] == gen)
 			i = (i+1) & mask;
 		table[i] = h;
+		stamp[i] = gen;
 	}
 
-	bool exists(hash_t h){
-		for(unsigned int i = h & mask; table[i]; i = (i+1) & mask)
+	bool exists(hash_t h) const {
+		for(unsigned int i = h & mask; stamp[i] == gen; i = (i+1) & mask)
 			if(table[i] == h)
 				return true;
 		return false;
@@ -51,4 +60,3 @@ public:
 		return v;
 	}
 };
-
@@ -83,6 +83,8 @@ public:
 		newcallback("verbose",         bind(&HavannahGTP::gtp_verbose,       this, _1), "Set verbosity, 0 for quiet, 1 for normal, 2+ for more output");
 		newcallback("extended",        bind(&HavannahGTP::gtp_extended,      this, _1), "Output extra stats from genmove in the response");
 		newcallback("debug",           bind(&HavannahGTP::gtp_debug,         this, _1), "Enable debug mode");
+		newcallback("bench_copy",      bind(&HavannahGTP::gtp_bench_copy,    this, _1), "Time copying a board of each size: bench_copy [iterations]");
+		newcallback("bench_weighted",  bind(&HavannahGTP::gtp_bench_weighted, this, _1), "Time the weighted random samplers used in rollouts: bench_weighted [games]");
 		newcallback("echo",            bind(&HavannahGTP::gtp_echo,          this, _1), "Return the arguments as the response");
 		newcallback("hguicoords",      bind(&HavannahGTP::gtp_hguicoords,    this, _1), "Switch coordinate systems to match HavannahGui");
 		newcallback("gridcoords",      bind(&HavannahGTP::gtp_gridcoords,    this, _1), "Switch coordinate systems to match Little Golem");
@@ -91,6 +93,7 @@ public:
 		newcallback("print",           bind(&HavannahGTP::gtp_print,         this, _1), "Alias for showboard");
 		newcallback("dists",           bind(&HavannahGTP::gtp_dists,         this, _1), "Similar to print, but shows minimum win distances");
 		newcallback("zobrist",         bind(&HavannahGTP::gtp_zobrist,       this, _1), "Output the zobrist hash for the current move");
+		newcallback("poscode",         bind(&HavannahGTP::gtp_poscode,       this, _1), "Output the exact canonical position code, or set up the position from one: poscode [code]");
 		newcallback("clear_board",     bind(&HavannahGTP::gtp_clearboard,    this, _1), "Clear the board, but keep the size");
 		newcallback("clear",           bind(&HavannahGTP::gtp_clearboard,    this, _1), "Alias for clear_board");
 		newcallback("boardsize",       bind(&HavannahGTP::gtp_boardsize,     this, _1), "Clear the board, set the board size");
@@ -109,8 +112,12 @@ public:
 		newcallback("pv",              bind(&HavannahGTP::gtp_pv,            this, _1), "Output the principle variation for the player tree as it stands now");
 		newcallback("time",            bind(&HavannahGTP::gtp_time,          this, _1), "Set the time limits and the algorithm for per game time");
 		newcallback("player_params",   bind(&HavannahGTP::gtp_player_params, this, _1), "Set the algorithm for the player, no args gives options");
+		newcallback("bench_tree",      bind(&HavannahGTP::gtp_bench_tree,    this, _1), "Grow the tree, then report the nodes per Gb and choose_move speed: bench_tree [runs] [passes] [depth]");
+		newcallback("rollout_counters", bind(&HavannahGTP::gtp_rollout_counters, this, _1), "Output the calls and cycles of each rollout feature since the last call, see player_params --counters");
 		newcallback("player_gammas",   bind(&HavannahGTP::gtp_player_gammas, this, _1), "Load the gammas for weighted random from a file");
+		newcallback("player_values",   bind(&HavannahGTP::gtp_player_values, this, _1), "Load the weights of the value function from a file");
 		newcallback("patterns",        bind(&HavannahGTP::gtp_patterns,      this, _1), "List all legal moves plus their local pattern");
+		newcallback("features",        bind(&HavannahGTP::gtp_features,      this, _1), "List the value function features of the position, and its value if loaded");
 		newcallback("all_legal",       bind(&HavannahGTP::gtp_all_legal,     this, _1), "List all legal moves");
 		newcallback("history",         bind(&HavannahGTP::gtp_history,       this, _1), "List of played moves");
 		newcallback("playgame",        bind(&HavannahGTP::gtp_playgame,      this, _1), "Play a list of moves");
@@ -158,6 +165,7 @@ public:
 	GTPResponse gtp_echo(vecstr args);
 	GTPResponse gtp_print(vecstr args);
 	GTPResponse gtp_zobrist(vecstr args);
+	GTPResponse gtp_poscode(vecstr args);
 	string won_str(int outcome) const;
 	GTPResponse gtp_swap(vecstr args);
 	GTPResponse gtp_boardsize(vecstr args);
@@ -169,6 +177,7 @@ public:
 	GTPResponse gtp_all_legal(vecstr args);
 	GTPResponse gtp_history(vecstr args);
 	GTPResponse gtp_patterns(vecstr args);
+	GTPResponse gtp_features(vecstr args);
 	GTPResponse play(const string & pos, int toplay);
 	GTPResponse gtp_playgame(vecstr args);
 	GTPResponse gtp_play(vecstr args);
@@ -183,6 +192,8 @@ public:
 	GTPResponse gtp_hguicoords(vecstr args);
 	GTPResponse gtp_gridcoords(vecstr args);
 	GTPResponse gtp_debug(vecstr args);
+	GTPResponse gtp_bench_copy(vecstr args);
+	GTPResponse gtp_bench_weighted(vecstr args);
 	GTPResponse gtp_dists(vecstr args);
 
 	GTPResponse gtp_time(vecstr args);
@@ -193,7 +204,10 @@ public:
 	GTPResponse gtp_pv(vecstr args);
 	GTPResponse gtp_genmove(vecstr args);
 	GTPResponse gtp_player_params(vecstr args);
+	GTPResponse gtp_rollout_counters(vecstr args);
+	GTPResponse gtp_bench_tree(vecstr args);
 	GTPResponse gtp_player_gammas(vecstr args);
+	GTPResponse gtp_player_values(vecstr args);
 	GTPResponse gtp_player_hgf(vecstr args);
 	GTPResponse gtp_player_load_hgf(vecstr args);
 	GTPResponse gtp_confirm_proof(vecstr args);
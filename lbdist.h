@@ -16,13 +16,12 @@ Decrease distance when crossing your own virtual connection?
 
 class LBDists {
 	struct MoveDist {
-		Move pos;
+		int pos; //xy
 		int dist;
 		int dir;
 
 		MoveDist() { }
-		MoveDist(Move p, int d, int r)       : pos(p),         dist(d), dir(r) { }
-		MoveDist(int x, int y, int d, int r) : pos(Move(x,y)), dist(d), dir(r) { }
+		MoveDist(int p, int d, int r) : pos(p), dist(d), dir(r) { }
 	};
 
 	//a specialized priority queue
@@ -30,7 +29,7 @@ class LBDists {
 	//new values must be the same as current smallest, or larger but smaller than min + maxvals
 	class IntPQueue {
 		static const int maxvals = 4; //maximum number of distinct values that can be stored
-		MoveDist vals[maxvals][361];
+		vector<MoveDist> vals[maxvals]; //each cell is pushed at most once per value, so vecsize() each is enough
 		int counts[maxvals];
 		int current; //which vector
 		int num; //int num elements total
@@ -38,6 +37,10 @@ class LBDists {
 		IntPQueue(){
 			reset();
 		}
+		void resize(int n){
+			for(int i = 0; i < maxvals; i++)
+				vals[i].resize(n);
+		}
 		void reset(){
 			current = 0;
 			num = 0;
@@ -65,20 +68,21 @@ class LBDists {
 		}
 	};
 
-	int dists[12][2][361]; //[edge/corner][player][cell]
+	vector<int> dists; //[edge/corner][player][cell], sized for the current board
 	static const int maxdist = 1000;
 	IntPQueue Q;
 	const Board * board;
 
-	int & dist(int edge, int player, int i)          { return dists[edge][player-1][i]; }
+	int & dist(int edge, int player, int i)          { return dists[(edge*2 + player-1)*board->vecsize() + i]; }
 	int & dist(int edge, int player, const Move & m) { return dist(edge, player, board->xy(m)); }
 	int & dist(int edge, int player, int x, int y)   { return dist(edge, player, board->xy(x, y)); }
 
 	void init(int x, int y, int edge, int player, int dir){
-		int val = board->get(x, y);
+		int i = board->xy(x, y);
+		int val = board->get(i);
 		if(val != 3 - player){
-			Q.push(MoveDist(x, y, (val == 0), dir));
-			dist(edge, player, x, y) = (val == 0);
+			Q.push(MoveDist(i, (val == 0), dir));
+			dist(edge, player, i) = (val == 0);
 		}
 	}
 
@@ -90,10 +94,8 @@ public:
 	void run(const Board * b, bool crossvcs = true, int side = 0) {
 		board = b;
 
-		for(int i = 0; i < 12; i++)
-			for(int j = 0; j < 2; j++)
-				for(int k = 0; k < board->vecsize(); k++)
-					dists[i][j][k] = maxdist; //far far away!
+		dists.assign(12*2*board->vecsize(), maxdist); //far far away!
+		Q.resize(board->vecsize());
 
 		int m = board->get_size()-1, e = board->get_size_d()-1;
 
@@ -118,34 +120,36 @@ public:
 		}
 	}
 
+	//works on xy with the board's neighbour offsets, the padding means a neighbour of an onboard cell is always in the array
 	void flood(int edge, int player, bool crossvcs){
 		int otherplayer = 3 - player;
+		int * d = & dist(edge, player, 0);
+		int size = board->get_size();
 
 		MoveDist cur;
 		while(Q.pop(cur)){
 			for(int i = 5; i <= 7; i++){
 				int nd = (cur.dir + i) % 6;
-				MoveDist next(cur.pos + neighbours[nd], cur.dist, nd);
+				MoveDist next(board->nb(cur.pos, nd), cur.dist, nd);
 
-				if(board->onboard(next.pos)){
-					int pos = board->xy(next.pos);
-					int colour = board->get(pos);
+				int colour = board->get(next.pos);
 
+				if(colour != 3){ //offboard sentinel
 					if(colour == otherplayer)
 						continue;
 
 					if(colour == 0){
 						if(!crossvcs && //forms a vc
-						   board->get(cur.pos + neighbours[(nd - 1) % 6]) == otherplayer &&
-						   board->get(cur.pos + neighbours[(nd + 1) % 6]) == otherplayer)
+						   board->get(board->nb(cur.pos, (nd + 5) % 6)) == otherplayer &&
+						   board->get(board->nb(cur.pos, (nd + 1) % 6)) == otherplayer)
 							continue;
 
 						next.dist++;
 					}
 
-					if( dist(edge, player, pos) > next.dist){
-						dist(edge, player, pos) = next.dist;
-						if(next.dist < board->get_size())
+					if(d[next.pos] > next.dist){
+						d[next.pos] = next.dist;
+						if(next.dist < size)
 							Q.push(next);
 					}
 				}
@@ -171,6 +175,19 @@ public:
 		return -outcome;
 	}
 
+	//the fewest stones player needs to finish a non-ring win, through any empty cell
+	int mindist(int player){
+		int best = maxdist;
+		for(int y = 0; y < board->get_size_d(); y++)
+			for(int x = board->linestart(y); x < board->lineend(y); x++)
+				if(board->get(x, y) == 0)
+					best = min(best, get(board->xy(x, y), player));
+		return best;
+	}
+
+	//whether a distance is a real path, rather than the sum of ones that were never reached
+	static bool reachable(int dist){ return dist < maxdist-5; }
+
 	int get(Move pos){ return min(get(pos, 1),  get(pos, 2)); }
 	int get(Move pos, int player){ return get(board->xy(pos), player); }
 	int get(int pos, int player){
@@ -3,6 +3,7 @@
 
 #include <stdint.h>
 #include <cstdlib>
+#include <cctype>
 #include "string.h"
 
 enum MoveSpecial {
@@ -18,14 +19,20 @@ struct Move {
 	Move(MoveSpecial a = M_UNKNOWN) : y(a), x(120) { } //big x so it will always wrap to y=0 with swap
 	Move(int X, int Y) : y(Y), x(X) { }
 
+	//coordinates are a row then a column, like a1. Rows go a to z then aa, ab, ac like spreadsheet columns,
+	//which only sizes 14 and 15 reach, so smaller boards keep the usual single letters
 	Move(const std::string & str, int size = 0){
 		if(     str == "swap"   ){ y = M_SWAP;    x = 120; }
 		else if(str == "resign" ){ y = M_RESIGN;  x = 120; }
 		else if(str == "none"   ){ y = M_NONE;    x = 120; }
 		else if(str == "unknown"){ y = M_UNKNOWN; x = 120; }
 		else{
-			y = tolower(str[0]) - 'a';
-			x = atoi(str.c_str() + 1) - 1;
+			unsigned int i = 0;
+			int row = 0;
+			for(; i < str.size() && isalpha(str[i]); i++)
+				row = row*26 + (tolower(str[i]) - 'a' + 1);
+			y = row - 1;
+			x = atoi(str.c_str() + i) - 1;
 
 			if(size && y >= size)
 				x += y + 1 - size;
@@ -39,9 +46,17 @@ struct Move {
 		if(y == M_RESIGN)  return "resign";
 
 		if(size && y >= size)
-			return std::string() + char(y + 'a') + to_str(x - y + size);
+			return row_str(y) + to_str(x - y + size);
 		else
-			return std::string() + char(y + 'a') + to_str(x + 1);
+			return row_str(y) + to_str(x + 1);
+	}
+
+	//the letters of row y, see the string constructor
+	static std::string row_str(int y, bool upper = false) {
+		std::string s;
+		for(int n = y + 1; n > 0; n = (n - 1)/26)
+			s.insert(s.begin(), char((upper ? 'A' : 'a') + (n - 1) % 26));
+		return s;
 	}
 
 	bool operator< (const Move & b) const { return (y == b.y ? x <  b.x : y <  b.y); }
@@ -72,15 +87,6 @@ struct MoveScore : public Move {
 	MoveScore operator+ (const Move & b) const { return MoveScore(x + b.x, y + b.y, score); }
 };
 
-struct MoveValid : public Move {
-	int16_t xy;
-
-	MoveValid() : Move(), xy(-1) { }
-	MoveValid(int x, int y, int XY) : Move(x,y), xy(XY) { }
-	MoveValid(const Move & m, int XY) : Move(m), xy(XY) { }
-	bool onboard() const { return xy != -1; }
-};
-
 struct PairMove {
 	Move a, b;
 	PairMove(Move A = M_UNKNOWN, Move B = M_UNKNOWN) : a(A), b(B) { }
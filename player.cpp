@@ -7,6 +7,7 @@
 #include "alarm.h"
 #include "time.h"
 #include "fileio.h"
+#include "positioncode.h"
 
 const float Player::min_rave = 0.1;
 
@@ -88,8 +89,10 @@ Player::Node * Player::genmove(double time, int max_runs, bool flexible){
 
 	runs = 0;
 	maxruns = max_runs;
-	for(unsigned int i = 0; i < threads.size(); i++)
+	for(unsigned int i = 0; i < threads.size(); i++){
 		threads[i]->reset();
+		threads[i]->setup(); //pick up any player_params changes
+	}
 
 	// if the move is forced and the time can be added to the clock, don't bother running at all
 	if(!flexible || root.children.num() != 1){
@@ -125,6 +128,7 @@ Player::Player() {
 	solved_logfile = NULL;
 
 	profile     = false;
+	rolloutcount = false;
 	ponder      = false;
 //#ifdef SINGLE_THREAD ... make sure only 1 thread
 	numthreads  = 1;
@@ -140,6 +144,7 @@ Player::Player() {
 	knowledge   = true;
 	userave     = 1;
 	useexplore  = 1;
+	usevalue    = 0;
 	fpurgency   = 1;
 	rollouts    = 1;
 	dynwiden    = 0;
@@ -160,7 +165,7 @@ Player::Player() {
 	bridge      = 25;
 	dists       = 0;
 
-	weightedrandom = false;
+	weightedrandom = 0;
 	checkrings     = 1.0;
 	checkringdepth = 1000;
 	minringsize    = 6;
@@ -170,6 +175,8 @@ Player::Player() {
 	lastgoodreply  = false;
 	instantwin     = 0;
 	instwindepth   = 1000;
+	truncate       = 0;
+	truncmargin    = 0;
 
 	for(int i = 0; i < 4096; i++)
 		gammas[i] = 1;
@@ -306,6 +313,11 @@ void Player::move(const Move & m){
 
 	rootboard.move(m, true, true);
 
+	for(unsigned int i = 0; i < threads.size(); i++){
+		threads[i]->reset();
+		threads[i]->setup(); //pick up the new rootboard
+	}
+
 	root.exp.addwins(visitexpand+1); //+1 to compensate for the virtual loss
 	if(rootboard.won() < 0)
 		root.outcome = -3;
@@ -348,7 +360,7 @@ void Player::logsolved(Board board, const Node * node, bool skiproot){
 //destroys the board, so use a copy!
 void Player::logsolved_unsafe(Board & board, const Node * node, bool skiproot){
 	if(!skiproot && node->outcome >= 0){
-		string s = board.hashstr() + "," + to_str(node->exp.num()) + "," + to_str(node->outcome) + "\n";
+		string s = board.hashstr() + "," + to_str(node->exp.num()) + "," + to_str(node->outcome) + "," + PositionCode::canonical(board).to_s() + "\n";
 		fprintf(solved_logfile, "%s", s.c_str());
 	}
 
@@ -481,7 +493,7 @@ void Player::create_children_simple(const Board & board, Node * node){
 
 	Node * child = node->children.begin(),
 		 * end   = node->children.end();
-	Board::MoveIterator moveit = board.moveit(prunesymmetry);
+	Board::MoveIterator moveit = board.moveit(prunesymmetry ? &unique : NULL);
 	int nummoves = 0;
 	for(; !moveit.done() && child != end; ++moveit, ++child){
 		*child = Node(*moveit);
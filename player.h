@@ -11,10 +11,14 @@
 #include "move.h"
 #include "board.h"
 #include "depthstats.h"
+#include "rolloutcounters.h"
 #include "thread.h"
 #include "xorshift.h"
 #include "weightedrandtree.h"
+#include "weightedrandbuckets.h"
 #include "lbdist.h"
+#include "valuefunc.h"
+#include "childscores.h"
 #include "compacttree.h"
 #include "log.h"
 #include "solverab.h"
@@ -22,14 +26,16 @@
 
 class Player {
 public:
+	//32 bit counts keep a Node at 32 bytes, two per cache line. s counts half wins, so 2^31 sims fit, the same as 32 bit builds always had
 	class ExpPair {
-		uword s, n;
-		ExpPair(uword S, uword N) : s(S), n(N) { }
+		u32 s, n;
+		ExpPair(u32 S, u32 N) : s(S), n(N) { }
 	public:
 		ExpPair() : s(0), n(0) { }
 		float avg() const { return 0.5f*s/n; }
-		uword num() const { return n; }
-		uword sum() const { return s/2; }
+		u32 num() const { return n; }
+		u32 sum() const { return s/2; }
+		u32 points() const { return s; } //2 per win and 1 per tie, so avg() is points()/(2*num())
 
 		void clear() { s = 0; n = 0; }
 
@@ -49,8 +55,9 @@ public:
 			n += a.n;
 		}
 
-		void addwins(uword num)  { n += num; s += 2*num; }
-		void addlosses(uword num){ n += num; }
+		void addwins(u32 num)  { n += num; s += 2*num; }
+		void addties(u32 num)  { n += num; s += num; }
+		void addlosses(u32 num){ n += num; }
 		ExpPair & operator+=(const ExpPair & a){
 			s += a.s;
 			n += a.n;
@@ -59,7 +66,7 @@ public:
 		ExpPair operator + (const ExpPair & a){
 			return ExpPair(s + a.s, n + a.n);
 		}
-		ExpPair & operator*=(uword m){
+		ExpPair & operator*=(u32 m){
 			s *= m;
 			n *= m;
 			return *this;
@@ -71,16 +78,15 @@ public:
 
 	struct Node {
 	public:
-		ExpPair rave;
+		//32 bytes: the 8 byte children pointer first so nothing needs padding, then what choose_move reads
+		CompactTree<Node>::Children children;
 		ExpPair exp;
+		ExpPair rave;
 		int16_t know;
 		int8_t  outcome;
 		uint8_t proofdepth;
 		Move    move;
 		Move    bestmove; //if outcome is set, then bestmove is the way to get there
-		CompactTree<Node>::Children children;
-//		int padding;
-		//seems to need padding to multiples of 8 bytes or it segfaults?
 		//don't forget to update the copy constructor/operator
 
 		Node()                            : know(0), outcome(-3), proofdepth(0)          { }
@@ -187,13 +193,14 @@ public:
 		};
 
 		ExpPair  exp[2];       //aggregated outcomes overall
-		ExpPair  rave[2][361]; //aggregated outcomes per move
-		RaveMove moves[361];   //moves made in order
+		vector<ExpPair> rave[2]; //aggregated outcomes per move, indexed by slot(), sized for the current board
+		vector<RaveMove> moves;  //moves made in order
 		int      tree;         //number of moves in the tree
 		int      rollout;      //number of moves in the rollout
+		uword    outcomes[3];  //ties, p1 wins, p2 wins in the playouts since the last finishbatch
 		Board *  board;        //reference to rootboard for xy()
 
-		MoveList() : tree(0), rollout(0), board(NULL) { }
+		MoveList() : tree(0), rollout(0), board(NULL) { outcomes[0] = outcomes[1] = outcomes[2] = 0; }
 
 		void addtree(const Move & move, char player){
 			moves[tree++] = RaveMove(move, player);
@@ -204,25 +211,34 @@ public:
 		void reset(Board * b){
 			tree = 0;
 			rollout = 0;
+			outcomes[0] = outcomes[1] = outcomes[2] = 0;
 			board = b;
 			exp[0].clear();
 			exp[1].clear();
-			for(int i = 0; i < b->vecsize(); i++){
+			if((int)moves.size() != b->vecsize()){ //only reallocates when the boardsize changes
+				moves.resize(b->vecsize());
+				rave[0].resize(b->vecsize()+1);
+				rave[1].resize(b->vecsize()+1);
+			}
+			for(int i = 0; i <= b->vecsize(); i++){
 				rave[0][i].clear();
 				rave[1][i].clear();
 			}
 		}
+		//where a move's rave is kept: xy for a cell, one slot past the cells for swap, which xy would put off the end
+		int slot(const Move & m) const {
+			return (m.y < 0 ? board->vecsize() : board->xy(m));
+		}
 		void finishrollout(int won){
-			exp[0].addloss();
-			exp[1].addloss();
-			if(won == 0){
-				exp[0].addtie();
-				exp[1].addtie();
-			}else{
-				exp[won-1].addwin();
-
-				for(RaveMove * i = begin(), * e = end(); i != e; i++){
-					ExpPair & r = rave[i->player-1][board->xy(*i)];
+			finishplayout(won);
+			finishbatch();
+		}
+		//one of several playouts from the same leaf: rave for its own rollout moves, the rest waits for finishbatch
+		void finishplayout(int won){
+			outcomes[won]++;
+			if(won > 0){
+				for(RaveMove * i = begin() + tree, * e = end(); i != e; i++){
+					ExpPair & r = rave[i->player-1][slot(*i)];
 					r.addloss();
 					if(i->player == won)
 						r.addwin();
@@ -230,18 +246,35 @@ public:
 			}
 			rollout = 0;
 		}
+		//add the outcomes of the playouts to the overall experience and the tree moves' rave in one pass
+		void finishbatch(){
+			for(int p = 0; p < 2; p++){
+				exp[p].addwins(outcomes[p+1]);
+				exp[p].addlosses(outcomes[2-p]);
+				exp[p].addties(outcomes[0]);
+			}
+			if(outcomes[1] || outcomes[2]){
+				for(RaveMove * i = begin(), * e = end(); i != e; i++){
+					int p = i->player;
+					ExpPair & r = rave[p-1][slot(*i)];
+					r.addwins(outcomes[p]);
+					r.addlosses(outcomes[3 - p]);
+				}
+			}
+			outcomes[0] = outcomes[1] = outcomes[2] = 0;
+		}
 		RaveMove * begin() {
-			return moves;
+			return & moves[0];
 		}
 		RaveMove * end() {
-			return moves + tree + rollout;
+			return & moves[0] + tree + rollout;
 		}
 		void subvlosses(int n){
 			exp[0].addlosses(-n);
 			exp[1].addlosses(-n);
 		}
 		const ExpPair & getrave(int player, const Move & move) const {
-			return rave[player-1][board->xy(move)];
+			return rave[player-1][slot(move)];
 		}
 		const ExpPair & getexp(int player) const {
 			return exp[player-1];
@@ -259,24 +292,35 @@ public:
 		DepthStats treelen, gamelen;
 		DepthStats wintypes[2][4]; //player,wintype
 		double times[4]; //time spent in each of the stages
+		RolloutCounters counters; //only counted with rolloutcount, kept until rollout_counters reads them
 
 		PlayerThread() : rand32(std::rand()), unitrand(std::rand()) {}
 		virtual ~PlayerThread() { }
-		virtual void reset() { }
+		virtual void reset() { } //clear the stats, safe while the threads are running
+		virtual void setup() { } //pick up the rootboard and params, only while the threads are stopped
 		int join(){ return thread.join(); }
 		void run(); //thread runner, calls iterate on each iteration
 		virtual void iterate() { } //handles each iteration
 	};
 
 	class PlayerUCT : public PlayerThread {
-		Move goodreply[2][361]; //361 is big enough for size 10 (ie 19x19), but no bigger...
+		vector<Move> goodreply[2]; //indexed by xy, sized for the current board
 		bool use_rave;    //whether to use rave for this simulation
 		bool use_explore; //whether to use exploration for this simulation
 		int  rollout_pattern_offset; //where to start the rollout pattern
-		Move moves[361]; //moves in the rollout
+		vector<Move> moves; //moves in the rollout, indexed by xy when using weighted random
+		vector<Move> basemoves; //the unshuffled moves, shared by the rollouts from one leaf
 		WeightedRandTree wtree[2]; //hold the weights for weighted random values, one per player
+		WeightedRandTree wtreebase[2]; //the weights at treeboard, kept in step as walk_tree makes and unmakes moves
+		WeightedRandBuckets wbuckets[2], wbucketsbase[2]; //the same with the constant time sampler
 		LBDists dists;    //holds the distances to the various non-ring wins as a heuristic for the minimum moves needed to win
+		ChildScores<Node> scores; //the unsolved children choose_move is looking at, scored together
 		MoveList movelist;
+		Board treeboard;  //copy of the rootboard that walk_tree makes and unmakes moves on
+		Board::UndoLog undolog;
+		Board::UniqueSets unique; //for pruning symmetric children
+		void (PlayerUCT::*rolloutfunc)(const Board & board, Move move, int depth, int n); //rollout instantiated for the current boardsize and policy
+		int policy; //the rollout features rolloutfunc was chosen for, kept until the next setup so a player_params change can't switch samplers mid search
 		int stage; //which of the four MCTS stages is it on
 		Time timestamps[4]; //timestamps for the beginning, before child creation, before rollout, after rollout
 
@@ -285,6 +329,7 @@ public:
 			PlayerThread();
 			player = p;
 			reset();
+			setup();
 			thread(bind(&PlayerUCT::run, this));
 		}
 
@@ -292,34 +337,75 @@ public:
 			treelen.reset();
 			gamelen.reset();
 
+			for(int a = 0; a < 2; a++)
+				for(int b = 0; b < 4; b++)
+					wintypes[a][b].reset();
+
+			for(int a = 0; a < 4; a++)
+				times[a] = 0;
+		}
+
+		void setup(){
+			assert(player->threadstate == Thread_Wait_Start); //walk_tree is using treeboard otherwise
+
+			int vs = player->rootboard.vecsize();
+			moves.resize(vs);
+			scores.resize(vs);
 			for(int p = 0; p < 2; p++)
-				for(int i = 0; i < 361; i++)
-					goodreply[p][i] = M_UNKNOWN;
+				goodreply[p].assign(vs, Move(M_UNKNOWN));
 
 			use_rave = false;
 			use_explore = false;
 			rollout_pattern_offset = 0;
 
-			for(int a = 0; a < 2; a++)
-				for(int b = 0; b < 4; b++)
-					wintypes[a][b].reset();
+			select_rollout(player->rootboard.get_size());
 
-			for(int a = 0; a < 4; a++)
-				times[a] = 0;
+			treeboard = player->rootboard;
+			undolog.clear();
+			treeboard.set_undolog(&undolog);
+
+			build_gammas(treeboard);
 		}
 
+		//time choose_move on every node down to maxdepth below node that has children, for bench_tree. Returns ns per call
+		double bench_choose_move(const Node * node, int toplay, int remain, int maxdepth, int passes, uint64_t & calls, uint64_t & children);
+
 	private:
 		void iterate();
 		void walk_tree(Board & board, Node * node, int depth);
 		bool create_children(Board & board, Node * node, int toplay);
 		void add_knowledge(Board & board, Node * node, Node * child);
-		Node * choose_move(const Node * node, int toplay, int remain) const;
+		Node * choose_move(const Node * node, int toplay, int remain);
 		void update_rave(const Node * node, int toplay);
 		bool test_bridge_probe(const Board & board, const Move & move, const Move & test) const;
 
-		int rollout(Board & board, Move move, int depth);
-		PairMove rollout_choose_move(Board & board, const Move & prev, int & doinstwin, bool checkrings);
-		Move rollout_pattern(const Board & board, const Move & move);
+		//rollout policy features, a rollout instantiation only has code for the ones in its mask
+		enum {
+			R_WEIGHTED = 1, //weightedrandom
+			R_INSTWIN  = 2, //instantwin, any level
+			R_REPLY    = 4, //rolloutpattern or lastgoodreply, which share one bit to keep the number of instantiations down
+			R_BUCKETS  = 8, //weightedrandom with WeightedRandBuckets instead of WeightedRandTree, only with R_WEIGHTED
+		};
+		void samplers(WeightedRandTree *& cur, WeightedRandTree *& base)       { cur = wtree;    base = wtreebase; }
+		void samplers(WeightedRandBuckets *& cur, WeightedRandBuckets *& base) { cur = wbuckets; base = wbucketsbase; }
+		int rollout_policy() const;
+		RolloutCounters::Counter * counter(int i) { return (player->rolloutcount ? & counters.c[i] : NULL); }
+
+		void build_gammas(const Board & board);
+		void update_gammas(const Board & board, const Move & move);
+		template<class W> void build_gammas(W * w, const Board & board);
+		template<class W> void update_gammas(W * w, const Board & board, const Move & move);
+		template<class W> void set_gammas(W * w, const Board & board, int i);
+
+		void select_rollout(int size);
+		template<int S> void select_rollout();
+		void rollout(const Board & board, Move move, int depth, int n){ (this->*rolloutfunc)(board, move, depth, n); }
+		template<int S, int P> void rollout(const Board & board, Move move, int depth, int n);
+		void value_rollout(const Board & board, int n);
+		template<int S, int P> int playout(Board & board, Move move, int depth, int num);
+		template<int S, int P> PairMove rollout_choose_move(Board & board, const Move & prev, int & doinstwin, bool checkrings);
+		template<int S> Move rollout_pattern(const Board & board, const Move & move);
+		int rollout_eval(const Board & board);
 	};
 
 
@@ -331,6 +417,7 @@ public:
 	int   numthreads; //number of player threads to run
 	u64   maxmem;     //maximum memory for the tree in bytes
 	bool  profile;    //count how long is spent in each stage of MCTS
+	bool  rolloutcount; //count the calls and cycles of each rollout feature, see rollout_counters
 //final move selection
 	float msrave;     //rave factor in final move selection, -1 means use number instead of value
 	float msexplore;  //the UCT constant in final move selection
@@ -342,6 +429,7 @@ public:
 	bool  knowledge;  //whether to include knowledge
 	float userave;    //what probability to use rave
 	float useexplore; //what probability to use UCT exploration
+	float usevalue;   //what probability to score a leaf with the value function instead of rollouts
 	float fpurgency;  //what value to return for a move that hasn't been played yet
 	int   rollouts;   //number of rollouts to run after the tree traversal
 	float dynwiden;   //dynamic widening, look at first log_dynwiden(experience) number of children, 0 to disable
@@ -362,7 +450,7 @@ public:
 	int   bridge;     //boost replying to a probe at a bridge
 	int   dists;      //boost based on minimum number of stones needed to finish a non-ring win
 //rollout
-	bool  weightedrandom; //use weighted random for move ordering based on gammas
+	int   weightedrandom; //use weighted random for move ordering based on gammas, 1 with WeightedRandTree, 2 with WeightedRandBuckets
 	float checkrings;     //how often to allow rings as a win condition in a rollout
 	float checkringdepth; //how deep to allow rings as a win condition in a rollout
 	float minringsize;    //how big is the minimum starting ring size (<6 is good)
@@ -372,8 +460,11 @@ public:
 	int   lastgoodreply;  //use the last-good-reply rollout heuristic
 	int   instantwin;     //look for instant wins in rollouts
 	int   instwindepth;   //how deep to look for instant wins
+	int   truncate;       //score rollouts by LBDists after this many moves instead of playing to the end, 0 to disable
+	int   truncmargin;    //only stop once one side is this many stones closer to a win, otherwise check again after another truncate moves
 
 	float gammas[4096]; //pattern weights for weighted random
+	ValueFunc valuefunc; //leaf evaluation, loaded by player_values
 
 	Board rootboard;
 	Node  root;
@@ -383,6 +474,7 @@ public:
 	uint64_t runs, maxruns;
 
 	CompactTree<Node> ctmem;
+	Board::UniqueSets unique; //for create_children_simple, which only runs on the gtp thread
 
 	string solved_logname;
 	FILE * solved_logfile;
@@ -12,10 +12,9 @@ void Player::PlayerUCT::iterate(){
 
 	movelist.reset(&(player->rootboard));
 	player->root.exp.addvloss();
-	Board copy = player->rootboard;
 	use_rave    = (unitrand() < player->userave);
 	use_explore = (unitrand() < player->useexplore);
-	walk_tree(copy, & player->root, 0);
+	walk_tree(treeboard, & player->root, 0);
 	player->root.exp.addv(movelist.getexp(3-player->rootboard.toplay()));
 
 	if(player->profile){
@@ -39,14 +38,17 @@ void Player::PlayerUCT::walk_tree(Board & board, Node * node, int depth){
 			if(child->outcome < 0){
 				movelist.addtree(child->move, toplay);
 
-				if(!board.move(child->move, (player->minimax == 0), (player->locality || player->weightedrandom) )){
+				if(!board.move(child->move, (player->minimax == 0), (player->locality || (policy & R_WEIGHTED)) )){
 					logerr("move failed: " + child->move.to_s() + "\n" + board.to_s(false));
 					assert(false && "move failed");
 				}
+				update_gammas(board, child->move);
 
 				child->exp.addvloss(); //balanced out after rollouts
 
 				walk_tree(board, child, depth+1);
+				board.undo();
+				update_gammas(board, child->move);
 
 				child->exp.addv(movelist.getexp(toplay));
 
@@ -83,11 +85,11 @@ void Player::PlayerUCT::walk_tree(Board & board, Node * node, int depth){
 			timestamps[2] = Time();
 		}
 
-		//do random game on this node
-		for(int i = 0; i < player->rollouts; i++){
-			Board copy = board;
-			rollout(copy, node->move, depth);
-		}
+		//do random games on this node, or score it directly
+		if(player->usevalue > 0 && player->valuefunc.is_loaded() && unitrand() < player->usevalue)
+			value_rollout(board, player->rollouts);
+		else
+			rollout(board, node->move, depth, player->rollouts);
 	}else{
 		movelist.finishrollout(won); //got to a terminal state, it's worth recording
 	}
@@ -137,15 +139,22 @@ bool Player::PlayerUCT::create_children(Board & board, Node * node, int toplay){
 	Node * child = temp.begin(),
 	     * end   = temp.end(),
 	     * loss  = NULL;
-	Board::MoveIterator move = board.moveit(player->prunesymmetry);
+	BitBoard wins, threats;
+	if(player->minimax){
+		wins = board.winning_cells(toplay);
+		if(player->minimax >= 2)
+			threats = board.winning_cells(3 - toplay);
+	}
+
+	Board::MoveIterator move = board.moveit(player->prunesymmetry ? &unique : NULL);
 	int nummoves = 0;
 	for(; !move.done() && child != end; ++move, ++child){
 		*child = Node(*move);
 
 		if(player->minimax){
-			child->outcome = board.test_win(*move);
+			child->outcome = board.test_win(*move, toplay, wins);
 
-			if(player->minimax >= 2 && board.test_win(*move, 3 - board.toplay()) > 0){
+			if(player->minimax >= 2 && board.test_win(*move, 3 - toplay, threats) > 0){
 				losses++;
 				loss = child;
 			}
@@ -196,40 +205,83 @@ bool Player::PlayerUCT::create_children(Board & board, Node * node, int toplay){
 	return true;
 }
 
-Player::Node * Player::PlayerUCT::choose_move(const Node * node, int toplay, int remain) const {
-	float val, maxval = -1000000000;
+Player::Node * Player::PlayerUCT::choose_move(const Node * node, int toplay, int remain){
 	float logvisits = log(node->exp.num());
-	int dynwidenlim = (player->dynwiden > 1.0 ? (int)(logvisits/player->logdynwiden)+2 : 361);
-
-	float raveval = use_rave * (player->ravefactor + player->decrrave*remain);
-	float explore = use_explore * player->explore;
+	int dynwidenlim = (player->dynwiden > 1.0 ? (int)(logvisits/player->logdynwiden)+2 : Board::max_cells);
+
+	ChildScores<Node>::Params params;
+	params.ravefactor = use_rave * (player->ravefactor + player->decrrave*remain);
+	params.userave    = (params.ravefactor > min_rave);
+	params.knowledge  = player->knowledge;
+	params.fpurgency  = player->fpurgency;
+	params.explore    = use_explore * player->explore;
+	params.logvisits  = logvisits;
 	if(player->parentexplore)
-		explore *= node->exp.avg();
+		params.explore *= node->exp.avg();
 
+	float maxval = -1000000000;
 	Node * ret = NULL,
 		 * child = node->children.begin(),
 		 * end   = node->children.end();
 
+	//score the solved children here, and gather the rest to be scored all at once, see Node::value
+	ChildScores<Node>::Gather gather = scores.gather();
 	for(; child != end && dynwidenlim >= 0; child++){
 		if(child->outcome >= 0){
 			if(child->outcome == toplay) //return a win immediately
 				return child;
 
-			val = (child->outcome == 0 ? -1 : -2); //-1 for tie so any unknown is better, -2 for loss so it's even worse
+			float val = (child->outcome == 0 ? -1 : -2); //-1 for tie so any unknown is better, -2 for loss so it's even worse
+			if(maxval < val){
+				maxval = val;
+				ret = child;
+			}
 		}else{
-			val = child->value(raveval, player->knowledge, player->fpurgency);
-			if(explore > 0)
-				val += explore*sqrt(logvisits/(child->exp.num() + 1));
+			gather.add(child, child->exp.points(), child->exp.num(), child->rave.points(), child->rave.num(), child->know);
 			dynwidenlim--;
 		}
+	}
+
+	float val;
+	Node * best = scores.best(gather, params, val);
+	if(best && (maxval < val || (maxval == val && best < ret))) //ties go to the earlier child
+		ret = best;
 
-		if(maxval < val){
-			maxval = val;
-			ret = child;
+	return ret;
+}
+
+double Player::PlayerUCT::bench_choose_move(const Node * node, int toplay, int remain, int maxdepth, int passes, uint64_t & calls, uint64_t & children){
+	//gather the nodes first so the timing is only choose_move, breadth first like the tree is laid out in memory
+	vector<const Node *> nodes;
+	vector<int> depths;
+	nodes.push_back(node);
+	depths.push_back(0);
+	for(unsigned int i = 0; i < nodes.size(); i++){
+		for(Node * c = nodes[i]->children.begin(), * e = nodes[i]->children.end(); c != e; c++){
+			if(c->children.num() && depths[i] + 1 < maxdepth){
+				nodes.push_back(c);
+				depths.push_back(depths[i] + 1);
+			}
 		}
 	}
 
-	return ret;
+	use_rave = (player->userave > 0);
+	use_explore = (player->useexplore > 0);
+
+	calls = children = 0;
+	uint64_t found = 0; //use the result so it isn't optimized away
+	Time start;
+	for(int p = 0; p < passes; p++){
+		for(unsigned int i = 0; i < nodes.size(); i++){
+			int d = depths[i];
+			found += (choose_move(nodes[i], (d % 2 ? 3 - toplay : toplay), remain - d) != NULL);
+			children += nodes[i]->children.num();
+		}
+		calls += nodes.size();
+	}
+	double t = Time() - start;
+
+	return (found ? t*1000000000/calls : 0);
 }
 
 /*
@@ -364,10 +416,8 @@ bool Player::PlayerUCT::test_bridge_probe(const Board & board, const Move & move
 	for(int i = 0; i < 8; i++){
 		Move cur = move + neighbours[i % 6];
 
-		bool on = board.onboard(cur);
-		int v = 0;
-		if(on)
-			v = board.get(cur);
+		int v = board.get(cur); //3 past the edge
+		bool on = (v != 3);
 
 	//state machine that progresses when it see the pattern, but counting borders as part of the pattern
 		if(state == 0){
@@ -400,45 +450,192 @@ bool Player::PlayerUCT::test_bridge_probe(const Board & board, const Move & move
 ///////////////////////////////////////////
 
 
-//play a random game starting from a board state, and return the results of who won
-int Player::PlayerUCT::rollout(Board & board, Move move, int depth){
-	int won;
-	int num = board.movesremain();
+//which rollout features are turned on in the player params
+int Player::PlayerUCT::rollout_policy() const {
+	return (player->weightedrandom      ? R_WEIGHTED : 0) |
+	       (player->weightedrandom == 2 ? R_BUCKETS  : 0) |
+	       (player->instantwin     ? R_INSTWIN  : 0) |
+	       (player->rolloutpattern || player->lastgoodreply ? R_REPLY : 0);
+}
+
+//the rollout is instantiated once per common boardsize so the board geometry is known at compile time
+//sizes without their own instantiation use the runtime size
+//this runs on every setup, so it also picks up player_params changes before the next search
+void Player::PlayerUCT::select_rollout(int size){
+	switch(size){
+		case 4:  select_rollout<4>();  break;
+		case 5:  select_rollout<5>();  break;
+		case 6:  select_rollout<6>();  break;
+		case 7:  select_rollout<7>();  break;
+		case 8:  select_rollout<8>();  break;
+		case 9:  select_rollout<9>();  break;
+		case 10: select_rollout<10>(); break;
+		case 11: select_rollout<11>(); break;
+		case 12: select_rollout<12>(); break;
+		case 13: select_rollout<13>(); break;
+		case 14: select_rollout<14>(); break;
+		case 15: select_rollout<15>(); break;
+		default: select_rollout<0>();  break;
+	}
+}
 
-	bool wrand = (player->weightedrandom);
+//and once per combination of policy features, so the features that are off cost nothing in the inner loop
+template<int S> void Player::PlayerUCT::select_rollout(){
+	policy = rollout_policy();
+	switch(policy){
+		case 0:  rolloutfunc = &PlayerUCT::rollout<S, 0>;  break;
+		case 1:  rolloutfunc = &PlayerUCT::rollout<S, 1>;  break;
+		case 2:  rolloutfunc = &PlayerUCT::rollout<S, 2>;  break;
+		case 3:  rolloutfunc = &PlayerUCT::rollout<S, 3>;  break;
+		case 4:  rolloutfunc = &PlayerUCT::rollout<S, 4>;  break;
+		case 5:  rolloutfunc = &PlayerUCT::rollout<S, 5>;  break;
+		case 6:  rolloutfunc = &PlayerUCT::rollout<S, 6>;  break;
+		case 7:  rolloutfunc = &PlayerUCT::rollout<S, 7>;  break;
+		case 9:  rolloutfunc = &PlayerUCT::rollout<S, 9>;  break;
+		case 11: rolloutfunc = &PlayerUCT::rollout<S, 11>; break;
+		case 13: rolloutfunc = &PlayerUCT::rollout<S, 13>; break;
+		default: rolloutfunc = &PlayerUCT::rollout<S, 15>; break;
+	}
+}
 
-	if(wrand){
-		wtree[0].resize(board.vecsize());
-		wtree[1].resize(board.vecsize());
+//the gamma weights of the board walk_tree is on are kept up to date move by move,
+//so a rollout starts from a copy of them instead of looking up the pattern of every empty cell
+void Player::PlayerUCT::build_gammas(const Board & board){
+	if(policy & R_BUCKETS)
+		build_gammas(wbucketsbase, board);
+	else if(policy & R_WEIGHTED)
+		build_gammas(wtreebase, board);
+
+	if(policy & R_WEIGHTED) //the samplers return xy, this maps it back to a move
+		for(int i = 0; i < board.vecsize(); i++)
+			moves[i] = board.xytomove(i);
+}
 
-		int set = 0;
-		for(Board::MoveIterator m = board.moveit(false, false); !m.done(); ++m){
-			int i = board.xy(*m);
-			moves[i] = *m;
-			unsigned int p = board.pattern(i);
-			wtree[0].set_weight_fast(i, player->gammas[p]);
-			wtree[1].set_weight_fast(i, player->gammas[board.pattern_invert(p)]);
-			set++;
-		}
+//a move was made or undone at move
+void Player::PlayerUCT::update_gammas(const Board & board, const Move & move){
+	if(policy & R_BUCKETS)
+		update_gammas(wbucketsbase, board, move);
+	else if(policy & R_WEIGHTED)
+		update_gammas(wtreebase, board, move);
+}
+
+//the weights of every empty cell, O(cells)
+template<class W> void Player::PlayerUCT::build_gammas(W * w, const Board & board){
+	w[0].resize(board.vecsize());
+	w[1].resize(board.vecsize());
+
+	for(Board::MoveIterator m = board.moveit(NULL, false); !m.done(); ++m){
+		int i = board.xy(*m);
+		unsigned int p = board.pattern(i);
+		w[0].set_weight_fast(i, player->gammas[p]);
+		w[1].set_weight_fast(i, player->gammas[board.pattern_invert(p)]);
+	}
 
-		wtree[0].rebuild_tree();
-		wtree[1].rebuild_tree();
+	w[0].rebuild_tree();
+	w[1].rebuild_tree();
+}
+
+//only the cell and its neighbours' patterns change, O(1) updates. A swap recolours a stone whose
+//neighbours aren't known here, but only happens at the top of the tree, so just rebuild
+template<class W> void Player::PlayerUCT::update_gammas(W * w, const Board & board, const Move & move){
+	if(move == M_SWAP){
+		build_gammas(w, board);
+		return;
+	}
+
+	int posxy = board.xy(move);
+	set_gammas(w, board, posxy);
+	for(int i = 0; i < 6; i++)
+		set_gammas(w, board, board.nb(posxy, i));
+}
+
+template<class W> void Player::PlayerUCT::set_gammas(W * w, const Board & board, int i){
+	if(board.get(i) == 0){
+		unsigned int p = board.pattern(i);
+		w[0].set_weight(i, player->gammas[p]);
+		w[1].set_weight(i, player->gammas[board.pattern_invert(p)]);
 	}else{
+		w[0].set_weight(i, 0);
+		w[1].set_weight(i, 0);
+	}
+}
+
+//stand in for n rollouts by drawing their outcomes from the value function, so the experience and rave
+//of the tree moves are updated the same way. There are no rollout moves to give rave to
+void Player::PlayerUCT::value_rollout(const Board & board, int n){
+	CycleTimer timer(counter(RolloutCounters::C_VALUE));
+	int turn = board.toplay();
+	float p = player->valuefunc.eval(board, dists);
+
+	for(int k = 0; k < n; k++)
+		movelist.finishplayout(unitrand() < p ? turn : 3 - turn);
+	movelist.finishbatch();
+}
+
+//the weighted random sampler a rollout policy uses
+template<bool buckets> struct RolloutSampler       { typedef WeightedRandTree    type; };
+template<>             struct RolloutSampler<true> { typedef WeightedRandBuckets type; };
+
+//play n random games starting from a board state, and add the results to the movelist
+//the empty cell list only depends on the starting board, so it's built once and copied for each game
+//the gamma weights for this board are already in wtreebase, kept up to date by walk_tree
+template<int S, int P> void Player::PlayerUCT::rollout(const Board & board, Move move, int depth, int n){
+	int num = board.movesremain();
+
+	const bool wrand = (P & R_WEIGHTED);
+	typename RolloutSampler<(P & R_BUCKETS) != 0>::type * wtree, * wtreebase;
+	samplers(wtree, wtreebase);
+
+	if(!wrand){
 		int i = 0;
-		for(Board::MoveIterator m = board.moveit(false, false); !m.done(); ++m)
+		for(Board::MoveIterator m = board.moveit(NULL, false); !m.done(); ++m)
 			moves[i++] = *m;
 
-		i = num;
-		while(i > 1){
-			int j = rand32() % i--;
-			Move tmp = moves[j];
-			moves[j] = moves[i];
-			moves[i] = tmp;
+		if(n > 1)
+			basemoves.assign(moves.begin(), moves.begin() + num);
+	}
+
+	for(int k = 0; k < n; k++){
+		Board copy;
+		{
+			CycleTimer timer(counter(RolloutCounters::C_SETUP));
+			if(wrand){
+				wtree[0].copy_weights(wtreebase[0]);
+				wtree[1].copy_weights(wtreebase[1]);
+			}else{
+				if(k > 0)
+					std::copy(basemoves.begin(), basemoves.end(), moves.begin());
+
+				int i = num;
+				while(i > 1){
+					int j = rand32() % i--;
+					Move tmp = moves[j];
+					moves[j] = moves[i];
+					moves[i] = tmp;
+				}
+			}
+
+			copy = board;
+			if(player->rolloutcount)
+				copy.set_ringstats(& counters.rings);
 		}
 
-//		random_shuffle(moves, moves + num);
+		movelist.finishplayout(playout<S, P>(copy, move, depth, num));
 	}
 
+	movelist.finishbatch();
+}
+
+//play out one game with the moves/weights prepared by rollout, and return who won
+template<int S, int P> int Player::PlayerUCT::playout(Board & board, Move move, int depth, int num){
+	CycleTimer timer(counter(RolloutCounters::C_PLAYOUT));
+	int won;
+
+	const bool wrand = (P & R_WEIGHTED);
+	const bool choose = (P & (R_INSTWIN | R_REPLY));
+	typename RolloutSampler<(P & R_BUCKETS) != 0>::type * wtree, * wtreebase;
+	samplers(wtree, wtreebase);
+
 	int doinstwin = player->instwindepth;
 	if(doinstwin < 0)
 		doinstwin *= - board.get_size();
@@ -462,19 +659,27 @@ int Player::PlayerUCT::rollout(Board & board, Move move, int depth){
 
 	int ringperm = player->ringperm;
 
-	Move * nextmove = moves;
+	int truncate = player->truncate;
+	int untilcut = truncate;
+
+	Move * nextmove = & moves[0];
 	Move forced = M_UNKNOWN;
 	while((won = board.won()) < 0){
 		int turn = board.toplay();
 
 		if(forced == M_UNKNOWN){
 			//do a complex choice
-			PairMove pair = rollout_choose_move(board, move, doinstwin, checkrings);
-			move = pair.a;
-			forced = pair.b;
+			if(choose){
+				PairMove pair = rollout_choose_move<S, P>(board, move, doinstwin, checkrings);
+				move = pair.a;
+				forced = pair.b;
+			}else{
+				move = M_UNKNOWN;
+			}
 
 			//or the simple random choice if complex found nothing
 			if(move == M_UNKNOWN){
+				CycleTimer timer(counter(RolloutCounters::C_RANDOM));
 				do{
 					if(wrand){
 						int j = wtree[turn-1].choose();
@@ -486,7 +691,7 @@ int Player::PlayerUCT::rollout(Board & board, Move move, int depth){
 						move = *nextmove;
 						nextmove++;
 					}
-				}while(!board.valid_move_fast(move));
+				}while(!board.valid_move_fast<S>(move));
 			}
 		}else{
 			move = forced;
@@ -495,7 +700,10 @@ int Player::PlayerUCT::rollout(Board & board, Move move, int depth){
 
 		movelist.addrollout(move, turn);
 
-		board.move(move, true, false, (checkrings ? minringsize : 0), ringperm);
+		{
+			CycleTimer timer(counter(RolloutCounters::C_MOVE));
+			board.move_rollout<S>(move, (checkrings ? minringsize : 0), ringperm);
+		}
 		if(--ringcounter == 0){
 			minringsize++;
 			ringcounter = ringcounterfull;
@@ -503,13 +711,26 @@ int Player::PlayerUCT::rollout(Board & board, Move move, int depth){
 		depth++;
 		checkrings &= (depth < checkdepth);
 
+		//stop early and score it statically, but only if the move didn't just end it
+		if(truncate && --untilcut == 0 && board.won() < 0){
+			untilcut = truncate;
+			CycleTimer timer(counter(RolloutCounters::C_EVAL));
+			if((won = rollout_eval(board)) >= 0){
+				timer.hit();
+				break;
+			}
+		}
+
 		if(wrand){
 			//update neighbour weights
-			for(const MoveValid * i = board.nb_begin(move), *e = board.nb_end(i); i < e; i++){
-				if(i->onboard() && board.get(i->xy) == 0){
-					unsigned int p = board.pattern(i->xy);
-					wtree[0].set_weight(i->xy, player->gammas[p]);
-					wtree[1].set_weight(i->xy, player->gammas[board.pattern_invert(p)]);
+			CycleTimer timer(counter(RolloutCounters::C_WEIGHTS));
+			int posxy = board.xy<S>(move);
+			for(int i = 0; i < 6; i++){
+				int n = board.nb(posxy, i);
+				if(board.get(n) == 0){
+					unsigned int p = board.pattern(n);
+					wtree[0].set_weight(n, player->gammas[p]);
+					wtree[1].set_weight(n, player->gammas[board.pattern_invert(p)]);
 				}
 			}
 		}
@@ -517,126 +738,113 @@ int Player::PlayerUCT::rollout(Board & board, Move move, int depth){
 
 	gamelen.add(depth);
 
-	if(won > 0)
+	if(won > 0) //a truncated rollout has no wintype, so it's counted under 0
 		wintypes[won-1][(int)board.getwintype()].add(depth);
 
 	//update the last good reply table
-	if(player->lastgoodreply && won > 0){
+	if((P & R_REPLY) && player->lastgoodreply && won > 0){
+		CycleTimer timer(counter(RolloutCounters::C_SAVE));
 		MoveList::RaveMove * rave = movelist.begin(), *raveend = movelist.end();
 
 		int m = -1;
 		while(rave != raveend){
 			if(m >= 0){
-				if(rave->player == won && *rave != M_SWAP)
+				if(rave->player == won && rave->y >= 0)
 					goodreply[rave->player - 1][m] = *rave;
 				else if(player->lastgoodreply == 2)
 					goodreply[rave->player - 1][m] = M_UNKNOWN;
 			}
-			m = board.xy(*rave);
+			m = (rave->y >= 0 ? board.xy<S>(*rave) : -1); //nothing replies to a swap
 			++rave;
 		}
 	}
 
-	movelist.finishrollout(won);
 	return won;
 }
 
-PairMove Player::PlayerUCT::rollout_choose_move(Board & board, const Move & prev, int & doinstwin, bool checkrings){
+template<int S, int P> PairMove Player::PlayerUCT::rollout_choose_move(Board & board, const Move & prev, int & doinstwin, bool checkrings){
 	//look for instant wins
-	if(player->instantwin == 1 && --doinstwin >= 0){
-		for(Board::MoveIterator m = board.moveit(); !m.done(); ++m)
-			if(board.test_win(*m, board.toplay(), checkrings) > 0)
-				return *m;
+	if((P & R_INSTWIN) && player->instantwin == 1 && --doinstwin >= 0){
+		CycleTimer timer(counter(RolloutCounters::C_INSTWIN));
+		int win = board.winning_cells(board.toplay(), checkrings).next(0);
+		if(win >= 0){
+			timer.hit();
+			return board.xytomove(win);
+		}
 	}
 
 	//look for instant wins and forced replies
-	if(player->instantwin == 2 && --doinstwin >= 0){
-		Move loss = M_UNKNOWN;
-		for(Board::MoveIterator m = board.moveit(); !m.done(); ++m){
-			if(board.test_win(*m, board.toplay(), checkrings) > 0) //win
-				return *m;
-			if(board.test_win(*m, 3 - board.toplay(), checkrings) > 0) //lose
-				loss = *m;
+	if((P & R_INSTWIN) && player->instantwin == 2 && --doinstwin >= 0){
+		CycleTimer timer(counter(RolloutCounters::C_INSTWIN));
+		int win = board.winning_cells(board.toplay(), checkrings).next(0);
+		if(win >= 0){
+			timer.hit();
+			return board.xytomove(win);
+		}
+
+		int loss = board.winning_cells(3 - board.toplay(), checkrings).next(0);
+		if(loss >= 0){
+			timer.hit();
+			return board.xytomove(loss);
 		}
-		if(loss != M_UNKNOWN)
-			return loss;
 	}
 
-	if(player->instantwin >= 3 && --doinstwin >= 0){
-		Move start, cur, loss = M_UNKNOWN;
+	if((P & R_INSTWIN) && player->instantwin >= 3 && --doinstwin >= 0){
+		CycleTimer timer(counter(RolloutCounters::C_INSTWIN));
+		Move loss = M_UNKNOWN;
 		int turn = 3 - board.toplay();
 
+		if(prev.y < 0) //swap, or no move at all
+			goto skipinstwin3;
+
+		int group = board.find_group(board.xy<S>(prev));
+
 		if(player->instantwin == 4){ //must have an edge or corner connection, or it has nothing to offer a group towards a win, ignores rings
-			const Board::Cell * c = board.cell(prev);
+			const Board::Cell * c = board.cell(group);
 			if(c->numcorners() == 0 && c->numedges() == 0)
 				goto skipinstwin3;
 
 		}
 
-//		logerr(board.to_s(true));
-
-		//find the first empty cell
-		int dir = -1;
-		for(int i = 0; i <= 5; i++){
-			start = prev + neighbours[i];
-
-			if(!board.onboard(start) || board.get(start) != turn){
-				dir = (i + 5) % 6;
-				break;
-			}
-		}
-
-		if(dir == -1) //possible if it's in the middle of a ring, which is possible if rings are being ignored
-			goto skipinstwin3;
-
-		cur = start;
-
-//		logerr(prev.to_s() + ":");
-
-		//follow contour of the current group looking for wins
-		do{
-//			logerr(" " + to_str((int)cur.y) + "," + to_str((int)cur.x));
-			//check the current cell
-			if(board.onboard(cur) && board.get(cur) == 0 && board.test_win(cur, turn, checkrings) > 0){
-//				logerr(" loss");
+		//check every liberty of the group that was just extended, including ones in pockets
+		BitBoard libs = board.liberties(group);
+		for(int i = libs.pop(); i >= 0; i = libs.pop()){
+			if(board.wins_at(i, turn, checkrings)){
+				Move cur = board.xytomove(i);
 				if(loss == M_UNKNOWN)
 					loss = cur;
-				else if(loss != cur)
+				else{
+					timer.hit();
 					return PairMove(loss, cur); //game over, two wins found for opponent
-			}
-
-			//advance to the next cell
-			for(int i = 5; i <= 9; i++){
-				int nd = (dir + i) % 6;
-				Move next = cur + neighbours[nd];
-
-				if(!board.onboard(next) || board.get(next) != turn){
-					cur = next;
-					dir = nd;
-					break;
 				}
 			}
-		}while(cur != start); //potentially skips part of it when the start is in a pocket, rare bug
-
-//		logerr("\n");
+		}
 
-		if(loss != M_UNKNOWN)
+		if(loss != M_UNKNOWN){
+			timer.hit();
 			return loss;
+		}
 	}
 skipinstwin3:
 
 	//force a bridge reply
-	if(player->rolloutpattern){
-		Move move = rollout_pattern(board, prev);
-		if(move != M_UNKNOWN)
+	if((P & R_REPLY) && player->rolloutpattern && prev.y >= 0){
+		CycleTimer timer(counter(RolloutCounters::C_PATTERN));
+		Move move = rollout_pattern<S>(board, prev);
+		if(move != M_UNKNOWN){
+			timer.hit();
 			return move;
+		}
 	}
 
 	//reuse the last good reply
-	if(player->lastgoodreply && prev != M_SWAP){
-		Move move = goodreply[board.toplay()-1][board.xy(prev)];
-		if(move != M_UNKNOWN && board.valid_move_fast(move))
+	if((P & R_REPLY) && player->lastgoodreply && prev.y >= 0){ //no reply to a swap or to no move at all
+		CycleTimer timer(counter(RolloutCounters::C_REPLY));
+		Move move = goodreply[board.toplay()-1][board.xy<S>(prev)];
+		if(move != M_UNKNOWN && board.valid_move_fast<S>(move)){
+			timer.hit();
 			return move;
+		}
 	}
 
 	return M_UNKNOWN;
@@ -647,18 +855,16 @@ skipinstwin3:
 //if you see a pattern of mine, empty, mine in the circle around the last move, their move
 //would break the virtual connection, so should be played
 //a virtual connection to a wall is also important
-Move Player::PlayerUCT::rollout_pattern(const Board & board, const Move & move){
+template<int S> Move Player::PlayerUCT::rollout_pattern(const Board & board, const Move & move){
 	Move ret;
 	int state = 0;
 	int a = (++rollout_pattern_offset % 6);
-	int piece = 3 - board.get(move);
+	int piece = 3 - board.get<S>(move);
 	for(int i = 0; i < 8; i++){
 		Move cur = move + neighbours[(i+a)%6];
 
-		bool on = board.onboard(cur);
-		int v = 0;
-		if(on)
-			v = board.get(cur);
+		int v = board.get<S>(cur); //3 past the edge
+		bool on = (v != 3);
 
 	//state machine that progresses when it see the pattern, but counting borders as part of the pattern
 		if(state == 0){
@@ -685,3 +891,22 @@ Move Player::PlayerUCT::rollout_pattern(const Board & board, const Move & move){
 	}
 	return M_UNKNOWN;
 }
+
+//score a truncated rollout by the fewest stones each side needs for a fork or bridge, ignoring rings
+//the side to move wins ties since it gets there first. -3 if neither is truncmargin stones closer
+int Player::PlayerUCT::rollout_eval(const Board & board){
+	dists.run(&board);
+
+	int turn = board.toplay();
+	int mine   = dists.mindist(turn),
+	    theirs = dists.mindist(3 - turn);
+
+	if(!LBDists::reachable(mine) && !LBDists::reachable(theirs)) //only a ring could still win
+		return 0;
+
+	int lead = theirs - mine;
+	if(abs(lead) < player->truncmargin)
+		return -3;
+
+	return (lead >= 0 ? turn : 3 - turn);
+}
@@ -0,0 +1,156 @@
+
+#pragma once
+
+//An exact, packed encoding of a position, 2 bits per cell, so unlike the zobrist hash it can't collide
+//and can be turned back into a board. Used to log positions and to check transposition table hits
+//Layout: 1 byte of boardsize, then the cells in row order, 4 per byte starting at the low bits,
+//0 = empty, 1 = white, 2 = black. Like the hash it holds only the stones, so who is to play comes
+//from the stone counts, which can't tell a swapped game with equal counts from an unswapped one
+
+#include <cstring>
+#include "board.h"
+#include "move.h"
+#include "string.h"
+
+class PositionCode {
+public:
+	static const int max_bytes = 1 + (2*Board::max_cells + 7)/8; //159 at size 15, 69 at size 10
+
+	uint8_t data[max_bytes];
+
+	PositionCode() { data[0] = 0; }
+
+	//the position as seen through transform t, see Board::sym_move. extra is a stone for toplay that isn't on the board yet
+	PositionCode(const Board & board, int t = 0, const Move & extra = M_NONE) {
+		encode(board, t, extra);
+	}
+
+	static int numbytes(int size) { return 1 + (2*(3*size*(size-1) + 1) + 7)/8; }
+	int numbytes() const { return numbytes(data[0]); }
+	int size() const { return data[0]; }
+
+	bool operator == (const PositionCode & o) const { return !memcmp(data, o.data, numbytes()); }
+	bool operator != (const PositionCode & o) const { return !(*this == o); }
+	bool operator <  (const PositionCode & o) const { return (memcmp(data, o.data, numbytes()) < 0); }
+
+	void encode(const Board & board, int t = 0, const Move & extra = M_NONE) {
+		int inv = sym_inverse[t];
+		int ex = (extra.y >= 0 ? board.xy(extra) : -1);
+		int turn = board.toplay();
+
+		memset(data, 0, numbytes(board.get_size()));
+		data[0] = board.get_size();
+
+		int k = 0;
+		for(int y = 0; y < board.get_size_d(); y++){
+			for(int x = board.linestart(y); x < board.lineend(y); x++, k++){
+				int i = board.sym_xy(board.xy(x, y), inv); //the cell that lands here under t
+				int p = (i == ex ? turn : board.get(i));
+				data[1 + (k >> 2)] |= p << ((k & 3) * 2);
+			}
+		}
+	}
+
+	//the smallest code over all 12 transforms, so symmetric positions share one code
+	static PositionCode canonical(const Board & board, const Move & extra = M_NONE) {
+		PositionCode best(board, 0, extra), c;
+		for(int t = 1; t < 12; t++){
+			c.encode(board, t, extra);
+			if(c < best)
+				best = c;
+		}
+		return best;
+	}
+
+	//a 32 bit check that is independent of the zobrist hash, for tables that can't afford the whole code
+	uint32_t fingerprint() const {
+		uint64_t h = 14695981039346656037ULL; //FNV-1a
+		for(int i = 0, n = numbytes(); i < n; i++)
+			h = (h ^ data[i]) * 1099511628211ULL;
+		return (uint32_t)(h ^ (h >> 32));
+	}
+
+	//the stones as a move list that recreates the position, alternating colours from white
+	//black only has the extra stone after a swap, so then it starts with white then swap. Equal counts decode unswapped
+	vector<Move> moves() const {
+		vector<Move> stones[2];
+		Board shape(size());
+		int k = 0;
+		for(int y = 0; y < shape.get_size_d(); y++){
+			for(int x = shape.linestart(y); x < shape.lineend(y); x++, k++){
+				int p = (data[1 + (k >> 2)] >> ((k & 3) * 2)) & 3;
+				if(p == 1 || p == 2)
+					stones[p-1].push_back(Move(x, y));
+			}
+		}
+
+		vector<Move> ret;
+		unsigned int w = 0, b = 0;
+		if(stones[1].size() == stones[0].size() + 1){
+			ret.push_back(stones[1][b++]);
+			ret.push_back(Move(M_SWAP));
+		}
+		while(w < stones[0].size() || b < stones[1].size()){
+			if(w < stones[0].size()) ret.push_back(stones[0][w++]);
+			if(b < stones[1].size()) ret.push_back(stones[1][b++]);
+		}
+		return ret;
+	}
+
+	//rebuild the board, groups included. The stones are placed without checking for wins,
+	//so the outcome of a finished position isn't set, and last() is arbitrary
+	Board decode() const {
+		Board board(size());
+		board.setswap(true);
+		vector<Move> m = moves();
+		for(unsigned int i = 0; i < m.size(); i++)
+			board.move(m[i], false);
+		board.setswap(false);
+		return board;
+	}
+
+	//does the data describe a position that could happen: a valid size, stone counts that alternate, nothing on unused bits
+	bool valid() const {
+		if(size() < 3 || size() > Board::max_size)
+			return false;
+		int cells = 3*size()*(size()-1) + 1, counts[4] = {0, 0, 0, 0};
+		for(int k = 0; k < cells; k++)
+			counts[(data[1 + (k >> 2)] >> ((k & 3) * 2)) & 3]++;
+		if(counts[3] || (cells & 3 && data[numbytes()-1] >> ((cells & 3) * 2)))
+			return false;
+		return (counts[1] == counts[2] || counts[1] == counts[2] + 1 || counts[2] == counts[1] + 1);
+	}
+
+	string to_s() const {
+		static const char hexlookup[] = "0123456789abcdef";
+		string s;
+		for(int i = 0, n = numbytes(); i < n; i++){
+			s += hexlookup[data[i] >> 4];
+			s += hexlookup[data[i] & 15];
+		}
+		return s;
+	}
+
+	//parse the output of to_s, false if it isn't a complete code
+	bool from_s(const string & s) {
+		data[0] = 0;
+		if(s.size() < 2 || s.size() > 2*(unsigned int)max_bytes || (s.size() & 1))
+			return false;
+		for(unsigned int i = 0; i < s.size(); i += 2){
+			int hi = hexval(s[i]), lo = hexval(s[i+1]);
+			if(hi < 0 || lo < 0)
+				return false;
+			data[i/2] = (hi << 4) | lo;
+		}
+		return (valid() && (int)s.size() == 2*numbytes());
+	}
+
+private:
+	static int hexval(char c) {
+		if(c >= '0' && c <= '9') return c - '0';
+		if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+		if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+		return -1;
+	}
+};
+
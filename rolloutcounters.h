@@ -0,0 +1,100 @@
+
+#pragma once
+
+//calls, hits and cpu cycles of each rollout feature, kept per thread and dumped by rollout_counters
+//cheap enough to leave on for a whole search, unlike --profile, which reads the clock 4 times per simulation
+
+#include <stdint.h>
+#include <string>
+#include "board.h"
+#include "string.h"
+#include "time.h"
+using namespace std;
+
+struct RolloutCounters {
+	enum {
+		C_SETUP,   //copying the board, move list or samplers for each game
+		C_PLAYOUT, //a whole game, including everything below
+		C_INSTWIN, //instant win and forced reply scans, hit if it found a move
+		C_PATTERN, //the bridge reply pattern, hit if it found a move
+		C_REPLY,   //last good reply lookups, hit if the reply was playable
+		C_RANDOM,  //picking a random or weighted random move when nothing above did
+		C_MOVE,    //placing the stone and checking for a win, ring searches included
+		C_WEIGHTS, //pattern lookups and sampler updates for the neighbours of the new stone
+		C_SAVE,    //updating the last good reply table after the game
+		C_EVAL,    //LBDists scoring of truncated games, hit if it decided the game
+		C_VALUE,   //value function leaves, standing in for a whole batch of games
+		NUM
+	};
+
+	struct Counter {
+		uint64_t calls, hits, cycles;
+	};
+
+	Counter c[NUM];
+	Board::RingStats rings; //checkring_df in the rollouts
+
+	RolloutCounters() { clear(); }
+
+	void clear(){
+		for(int i = 0; i < NUM; i++)
+			c[i].calls = c[i].hits = c[i].cycles = 0;
+		rings.clear();
+	}
+
+	RolloutCounters & operator += (const RolloutCounters & o){
+		for(int i = 0; i < NUM; i++){
+			c[i].calls  += o.c[i].calls;
+			c[i].hits   += o.c[i].hits;
+			c[i].cycles += o.c[i].cycles;
+		}
+		rings += o.rings;
+		return *this;
+	}
+
+	static const char * name(int i){
+		static const char * names[NUM] = {"setup", "playout", "instwin", "pattern", "reply", "random", "move", "weights", "save", "eval", "value"};
+		return names[i];
+	}
+
+	//one line per feature that was used, with the cost per call and per game
+	string to_s() const {
+		uint64_t games = c[C_PLAYOUT].calls;
+		string s = "feature " + pad("calls", 11) + pad("hits", 11) + pad("Mcycles", 9) + pad("cyc/call", 10) + pad("cyc/game", 10) + "\n";
+		for(int i = 0; i < NUM; i++){
+			if(c[i].calls == 0)
+				continue;
+			s += string(name(i)) + string(8 - string(name(i)).size(), ' ');
+			s += pad(to_str(c[i].calls), 11) + pad(to_str(c[i].hits), 11);
+			s += pad(to_str(c[i].cycles/1000000.0, 1), 9);
+			s += pad(to_str((double)c[i].cycles/c[i].calls, 0), 10);
+			s += pad(games ? to_str((double)c[i].cycles/games, 0) : string("-"), 10) + "\n";
+		}
+		s += "ring searches " + to_str(rings.calls) + ", stones visited " + to_str(rings.steps) + ", deepest " + to_str(rings.maxdepth);
+		return s;
+	}
+
+private:
+	static string pad(const string & s, unsigned int width){
+		return (s.size() < width ? string(width - s.size(), ' ') + s : " " + s);
+	}
+};
+
+//adds the cycles from construction to destruction to a counter, nothing if the counter is NULL
+class CycleTimer {
+	RolloutCounters::Counter * c;
+	uint64_t start;
+public:
+	CycleTimer(RolloutCounters::Counter * counter) : c(counter), start(c ? rdtsc() : 0) { }
+	~CycleTimer(){
+		if(c){
+			c->cycles += rdtsc() - start;
+			c->calls++;
+		}
+	}
+	void hit(){
+		if(c)
+			c->hits++;
+	}
+};
+
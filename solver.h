@@ -27,41 +27,33 @@ protected:
 	volatile bool timeout;
 	void timedout(){ timeout = true; }
 	Board rootboard;
+	Board::UndoLog undolog; //for the copy of the rootboard that the search makes and unmakes moves on
+	Board::UniqueSets unique; //for iterating over the moves without symmetric duplicates
 
+	//one stone wins, or the game is a draw if this is the last empty cell
 	static int solve1ply(const Board & board, int & nodes) {
-		int outcome = -3;
 		int turn = board.toplay();
-		for(Board::MoveIterator move = board.moveit(true); !move.done(); ++move){
+		if(board.winning_cells(turn).any()){
 			++nodes;
-			int won = board.test_win(*move, turn);
-
-			if(won == turn)
-				return won;
-			if(won == 0)
-				outcome = 0;
+			return turn;
 		}
-		return outcome;
+
+		nodes += board.movesremain();
+		return (board.movesremain() == 1 ? 0 : -3);
 	}
 
+	//as solve1ply, but also a loss if the opponent has two different ways to win
 	static int solve2ply(const Board & board, int & nodes) {
-		int losses = 0;
-		int outcome = -3;
 		int turn = board.toplay(), opponent = 3 - turn;
-		for(Board::MoveIterator move = board.moveit(true); !move.done(); ++move){
+		if(board.winning_cells(turn).any()){
 			++nodes;
-			int won = board.test_win(*move, turn);
-
-			if(won == turn)
-				return won;
-			if(won == 0)
-				outcome = 0;
-
-			if(board.test_win(*move, opponent) > 0)
-				losses++;
+			return turn;
 		}
-		if(losses >= 2)
+
+		nodes += board.movesremain();
+		if(board.winning_cells(opponent).count() >= 2)
 			return opponent;
-		return outcome;
+		return (board.movesremain() == 1 ? 0 : -3);
 	}
 
 };
@@ -20,18 +20,21 @@ void SolverAB::solve(double time){
 
 	int turn = rootboard.toplay();
 
+	Board board = rootboard;
+	undolog.clear();
+	board.set_undolog(&undolog);
+
 	for(maxdepth = startdepth; !timeout; maxdepth++){
 //		logerr("Starting depth " + to_str(maxdepth) + "\n");
 
 		//the first depth of negamax
 		int ret, alpha = -2, beta = 2;
-		for(Board::MoveIterator move = rootboard.moveit(true); !move.done(); ++move){
+		for(Board::MoveIterator move = board.moveit(&unique); !move.done(); ++move){
 			nodes_seen++;
 
-			Board next = rootboard;
-			next.move(*move, true, false);
-
-			int value = -negamax(next, maxdepth - 1, -beta, -alpha);
+			board.move(*move, true, false);
+			int value = -negamax(board, maxdepth - 1, -beta, -alpha);
+			board.undo();
 
 			if(value > alpha){
 				alpha = value;
@@ -59,7 +62,7 @@ void SolverAB::solve(double time){
 }
 
 
-int SolverAB::negamax(const Board & board, const int depth, int alpha, int beta){
+int SolverAB::negamax(Board & board, const int depth, int alpha, int beta){
 	if(board.won() >= 0)
 		return (board.won() ? -2 : -1);
 
@@ -70,25 +73,35 @@ int SolverAB::negamax(const Board & board, const int depth, int alpha, int beta)
 	int first = true;
 	int value, losses = 0;
 	static const int lookup[6] = {0, 0, 0, 1, 2, 2};
-	for(Board::MoveIterator move = board.moveit(true); !move.done(); ++move){
+	BitBoard wins, threats;
+	if(depth <= 2){
+		wins = board.winning_cells(board.toplay());
+		if(wins.any()){ //one of the moves wins, which is a cutoff no matter the window
+			nodes_seen++;
+			return beta;
+		}
+		threats = board.winning_cells(3 - board.toplay());
+	}
+	for(Board::MoveIterator move = board.moveit(&unique); !move.done(); ++move){
 		nodes_seen++;
 
 		hash_t hash = board.test_hash(*move);
 		if(int ttval = tt_get(hash)){
 			value = ttval;
 		}else if(depth <= 2){
-			value = lookup[board.test_win(*move)+3];
+			value = lookup[board.test_win(*move, board.toplay(), wins)+3];
 
-			if(board.test_win(*move, 3 - board.toplay()) > 0)
+			if(board.test_win(*move, 3 - board.toplay(), threats) > 0)
 				losses++;
 		}else{
-			Board next = board;
-			next.move(*move, true, false);
+			board.move(*move, true, false);
 
-			value = -negamax(next, depth - 1, -b, -alpha);
+			value = -negamax(board, depth - 1, -b, -alpha);
 
 			if(scout && value > alpha && value < beta && !first) // re-search
-				value = -negamax(next, depth - 1, -beta, -alpha);
+				value = -negamax(board, depth - 1, -beta, -alpha);
+
+			board.undo();
 		}
 		tt_set(hash, value);
 
@@ -111,7 +124,10 @@ int SolverAB::negamax(const Board & board, const int depth, int alpha, int beta)
 }
 
 int SolverAB::negamax_outcome(const Board & board, const int depth){
-	int abval = negamax(board, depth, -2, 2);
+	Board copy = board;
+	undolog.clear();
+	copy.set_undolog(&undolog);
+	int abval = negamax(copy, depth, -2, 2);
 	if(     abval == 0)  return -3; //unknown
 	else if(abval == 2)  return board.toplay(); //win
 	else if(abval == -2) return 3 - board.toplay(); //loss
@@ -47,8 +47,12 @@ void SolverPNS::solve(double time){
 }
 
 void SolverPNS::run_pns(){
+	Board board = rootboard;
+	undolog.clear();
+	board.set_undolog(&undolog);
+
 	while(!timeout && root.phi != 0 && root.delta != 0){
-		if(!pns(rootboard, &root, 0, INF32/2, INF32/2)){
+		if(!pns(board, &root, 0, INF32/2, INF32/2)){
 			logerr("Starting solver GC with limit " + to_str(gclimit) + " ... ");
 
 			Time starttime;
@@ -69,7 +73,7 @@ void SolverPNS::run_pns(){
 	}
 }
 
-bool SolverPNS::pns(const Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td){
+bool SolverPNS::pns(Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td){
 	iters++;
 	if(maxdepth < depth)
 		maxdepth = depth;
@@ -85,16 +89,17 @@ bool SolverPNS::pns(const Board & board, PNSNode * node, int depth, uint32_t tp,
 			dists.run(&board);
 
 		int i = 0;
-		for(Board::MoveIterator move = board.moveit(true); !move.done(); ++move){
+		for(Board::MoveIterator move = board.moveit(&unique); !move.done(); ++move){
 			int outcome, pd;
 
 			if(ab){
-				Board next = board;
-				next.move(*move, false, false);
+				board.move(*move, false, false);
 
 				pd = 0;
-				outcome = (ab == 1 ? solve1ply(next, pd) : solve2ply(next, pd));
+				outcome = (ab == 1 ? solve1ply(board, pd) : solve2ply(board, pd));
 				nodes_seen += pd;
+
+				board.undo();
 			}else{
 				outcome = board.test_win(*move);
 				pd = 1;
@@ -142,13 +147,14 @@ bool SolverPNS::pns(const Board & board, PNSNode * node, int depth, uint32_t tp,
 				child++;
 		}
 
-		Board next = board;
-		next.move(child->move, false, false);
+		board.move(child->move, false, false);
 
 		uint64_t itersbefore = iters;
-		mem = pns(next, child, depth + 1, tpc, tdc);
+		mem = pns(board, child, depth + 1, tpc, tdc);
 		child->work += iters - itersbefore;
 
+		board.undo();
+
 		if(child->phi == 0 || child->delta == 0) //clear child's children
 			nodes -= child->dealloc(ctmem);
 
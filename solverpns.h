@@ -196,7 +196,7 @@ public:
 
 //basic proof number search building a tree
 	void run_pns();
-	bool pns(const Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td);
+	bool pns(Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td);
 
 //update the phi and delta for the node
 	bool updatePDnum(PNSNode * node);
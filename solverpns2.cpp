@@ -79,8 +79,13 @@ void SolverPNS2::SolverThread::run(){
 				break;
 			}
 
-			pns(solver->rootboard, &solver->root, 0, INF32/2, INF32/2);
+		{
+			Board board = solver->rootboard;
+			undolog.clear();
+			board.set_undolog(&undolog);
+			pns(board, &solver->root, 0, INF32/2, INF32/2);
 			break;
+		}
 
 		case Thread_GC:         //one thread is running garbage collection, the rest are waiting
 		case Thread_GC_End:     //once done garbage collecting, go to wait_end instead of back to running
@@ -169,7 +174,7 @@ void SolverPNS2::reset_threads(){ //start and end with threadstate = Thread_Wait
 }
 
 
-bool SolverPNS2::SolverThread::pns(const Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td){
+bool SolverPNS2::SolverThread::pns(Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td){
 	iters++;
 	if(solver->maxdepth < depth)
 		solver->maxdepth = depth;
@@ -193,16 +198,17 @@ bool SolverPNS2::SolverThread::pns(const Board & board, PNSNode * node, int dept
 			dists.run(&board);
 
 		int i = 0;
-		for(Board::MoveIterator move = board.moveit(true); !move.done(); ++move){
+		for(Board::MoveIterator move = board.moveit(&unique); !move.done(); ++move){
 			int outcome, pd;
 
 			if(solver->ab){
-				Board next = board;
-				next.move(*move, false, false);
+				board.move(*move, false, false);
 
 				pd = 0;
-				outcome = (solver->ab == 1 ? solve1ply(next, pd) : solve2ply(next, pd));
+				outcome = (solver->ab == 1 ? solve1ply(board, pd) : solve2ply(board, pd));
 				PLUS(solver->nodes_seen, pd);
+
+				board.undo();
 			}else{
 				outcome = board.test_win(*move);
 				pd = 1;
@@ -253,13 +259,14 @@ bool SolverPNS2::SolverThread::pns(const Board & board, PNSNode * node, int dept
 					child = i;
 		}
 
-		Board next = board;
-		next.move(child->move, false, false);
+		board.move(child->move, false, false);
 
 		child->ref();
 		uint64_t itersbefore = iters;
-		mem = pns(next, child, depth + 1, tpc, tdc);
+		mem = pns(board, child, depth + 1, tpc, tdc);
 		child->deref();
+
+		board.undo();
 		PLUS(child->work, iters - itersbefore);
 
 		if(updatePDnum(node) && !solver->df)
@@ -114,6 +114,8 @@ public:
 	public:
 		uint64_t iters;
 		LBDists dists;    //holds the distances to the various non-ring wins as a heuristic for the minimum moves needed to win
+		Board::UndoLog undolog; //for this thread's copy of the rootboard
+		Board::UniqueSets unique; //for this thread's move iteration
 
 		SolverThread(SolverPNS2 * s) : solver(s), iters(0) {
 			thread(bind(&SolverThread::run, this));
@@ -126,7 +128,7 @@ public:
 		void run(); //thread runner
 
 	//basic proof number search building a tree
-		bool pns(const Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td);
+		bool pns(Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td);
 
 	//update the phi and delta for the node
 		bool updatePDnum(PNSNode * node);
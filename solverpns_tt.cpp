@@ -20,7 +20,7 @@ void SolverPNSTT::solve(double time){
 
 	if(root.phi == 0 && root.delta == LOSS){ //look for the winning move
 		PNSNode * i = NULL;
-		for(Board::MoveIterator move = rootboard.moveit(true); !move.done(); ++move){
+		for(Board::MoveIterator move = rootboard.moveit(&unique); !move.done(); ++move){
 			i = tt(rootboard, *move);
 			if(i->delta == 0){
 				bestmove = *move;
@@ -30,7 +30,7 @@ void SolverPNSTT::solve(double time){
 		outcome = rootboard.toplay();
 	}else if(root.phi == 0 && root.delta == DRAW){ //look for the move to tie
 		PNSNode * i = NULL;
-		for(Board::MoveIterator move = rootboard.moveit(true); !move.done(); ++move){
+		for(Board::MoveIterator move = rootboard.moveit(&unique); !move.done(); ++move){
 			i = tt(rootboard, *move);
 			if(i->delta == DRAW){
 				bestmove = *move;
@@ -52,12 +52,18 @@ void SolverPNSTT::solve(double time){
 void SolverPNSTT::run_pns(){
 	if(TT == NULL)
 		TT = new PNSNode[maxnodes];
+	if(verify && TTcheck == NULL)
+		TTcheck = new uint32_t[maxnodes]();
+
+	Board board = rootboard;
+	undolog.clear();
+	board.set_undolog(&undolog);
 
 	while(!timeout && root.phi != 0 && root.delta != 0)
-		pns(rootboard, &root, 0, INF32/2, INF32/2);
+		pns(board, &root, 0, INF32/2, INF32/2);
 }
 
-void SolverPNSTT::pns(const Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td){
+void SolverPNSTT::pns(Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td){
 	if(depth > maxdepth)
 		maxdepth = depth;
 
@@ -70,7 +76,7 @@ void SolverPNSTT::pns(const Board & board, PNSNode * node, int depth, uint32_t t
 		uint32_t tpc, tdc;
 
 		PNSNode * i = NULL;
-		for(Board::MoveIterator move = board.moveit(true); !move.done(); ++move){
+		for(Board::MoveIterator move = board.moveit(&unique); !move.done(); ++move){
 			i = tt(board, *move);
 			if(child == NULL){
 				child = child2 = i;
@@ -94,27 +100,14 @@ void SolverPNSTT::pns(const Board & board, PNSNode * node, int depth, uint32_t t
 				tpc = tdc = 0;
 			}
 
-			Board next = board;
-			next.move(move1);//, false, false);
-			pns(next, child, depth + 1, tpc, tdc);
+			board.move(move1);//, false, false);
+			pns(board, child, depth + 1, tpc, tdc);
 
 			//just found a loss, try to copy proof to siblings
-			if(copyproof && child->delta == LOSS){
-//				logerr("!" + move1.to_s() + " ");
-				int count = abs(copyproof);
-				for(Board::MoveIterator move = board.moveit(true); count-- && !move.done(); ++move){
-					if(!tt(board, *move)->terminal()){
-//						logerr("?" + move->to_s() + " ");
-						Board sibling = board;
-						sibling.move(*move);
-						copy_proof(next, sibling, move1, *move);
-						updatePDnum(sibling);
-
-						if(copyproof < 0 && !tt(sibling)->terminal())
-							break;
-					}
-				}
-			}
+			if(copyproof && child->delta == LOSS)
+				copy_proof_siblings(board, move1);
+			else
+				board.undo();
 		}
 
 		if(updatePDnum(board, node) && !df) //must pass node to updatePDnum since it may refer to the root which isn't in the TT
@@ -124,7 +117,8 @@ void SolverPNSTT::pns(const Board & board, PNSNode * node, int depth, uint32_t t
 }
 
 bool SolverPNSTT::updatePDnum(const Board & board, PNSNode * node){
-	hash_t hash = board.gethash();
+	int transform;
+	hash_t hash = board.gethash(transform);
 
 	if(node == NULL)
 		node = TT + (hash % maxnodes);
@@ -134,7 +128,7 @@ bool SolverPNSTT::updatePDnum(const Board & board, PNSNode * node){
 
 	bool win = false;
 	PNSNode * i = NULL;
-	for(Board::MoveIterator move = board.moveit(true); !move.done(); ++move){
+	for(Board::MoveIterator move = board.moveit(&unique); !move.done(); ++move){
 		i = tt(board, *move);
 
 		win |= (i->phi == LOSS);
@@ -152,6 +146,8 @@ bool SolverPNSTT::updatePDnum(const Board & board, PNSNode * node){
 		return false;
 	}else{
 		node->hash = hash; //just in case it was overwritten by something else
+		if(TTcheck && node != &root)
+			TTcheck[node - TT] = PositionCode(board, transform).fingerprint();
 		if(sum == 0 && min == DRAW){
 			node->phi = 0;
 			node->delta = DRAW;
@@ -163,6 +159,28 @@ bool SolverPNSTT::updatePDnum(const Board & board, PNSNode * node){
 	}
 }
 
+//board has just had move1 played, which was proven a loss, so try the same proof on its siblings, then undo move1
+//kept out of pns so the board copies aren't part of every level of its recursion
+void SolverPNSTT::copy_proof_siblings(Board & board, const Move & move1){
+	Board next = board;
+	board.undo();
+
+//	logerr("!" + move1.to_s() + " ");
+	int count = abs(copyproof);
+	for(Board::MoveIterator move = board.moveit(&unique); count-- && !move.done(); ++move){
+		if(!tt(board, *move)->terminal()){
+//			logerr("?" + move->to_s() + " ");
+			Board sibling = board;
+			sibling.move(*move);
+			copy_proof(next, sibling, move1, *move);
+			updatePDnum(sibling);
+
+			if(copyproof < 0 && !tt(sibling)->terminal())
+				break;
+		}
+	}
+}
+
 //source is a move that is a proven loss, and dest is an unproven sibling
 //each has one move that the other doesn't, which are stored in smove and dmove
 //if either move is used but only available in one board, the other is substituted
@@ -172,7 +190,7 @@ void SolverPNSTT::copy_proof(const Board & source, const Board & dest, Move smov
 
 	//find winning move from the source tree
 	Move bestmove = M_UNKNOWN;
-	for(Board::MoveIterator move = source.moveit(true); !move.done(); ++move){
+	for(Board::MoveIterator move = source.moveit(&unique); !move.done(); ++move){
 		if(tt(source, *move)->phi == LOSS){
 			bestmove = *move;
 			break;
@@ -203,7 +221,7 @@ void SolverPNSTT::copy_proof(const Board & source, const Board & dest, Move smov
 		return;
 
 	//test all responses
-	for(Board::MoveIterator move = dest2.moveit(true); !move.done(); ++move){
+	for(Board::MoveIterator move = dest2.moveit(&unique); !move.done(); ++move){
 		if(tt(dest2, *move)->terminal())
 			continue;
 
@@ -230,12 +248,31 @@ void SolverPNSTT::copy_proof(const Board & source, const Board & dest, Move smov
 	updatePDnum(dest2);
 }
 
+//is the position in this slot, and with verify, is it really the same position and not just the same hash
+//on a miss with verify the slot's fingerprint is replaced, the caller fills in the node
+bool SolverPNSTT::tt_hit(PNSNode * node, hash_t hash, const Board & board, int transform, Move move){
+	if(!verify || !TTcheck)
+		return (node->hash == hash);
+
+	uint32_t check = PositionCode(board, transform, move).fingerprint();
+	uint32_t & slot = TTcheck[node - TT];
+
+	if(node->hash == hash){
+		if(slot == check)
+			return true;
+		collisions++;
+	}
+	slot = check;
+	return false;
+}
+
 SolverPNSTT::PNSNode * SolverPNSTT::tt(const Board & board){
-	hash_t hash = board.gethash();
+	int transform;
+	hash_t hash = board.gethash(transform);
 
 	PNSNode * node = TT + (hash % maxnodes);
 
-	if(node->hash != hash){
+	if(!tt_hit(node, hash, board, transform)){
 		int outcome, pd;
 
 		if(ab){
@@ -255,11 +292,12 @@ SolverPNSTT::PNSNode * SolverPNSTT::tt(const Board & board){
 }
 
 SolverPNSTT::PNSNode * SolverPNSTT::tt(const Board & board, Move move){
-	hash_t hash = board.test_hash(move, board.toplay());
+	int transform;
+	hash_t hash = board.test_hash(move, board.toplay(), transform);
 
 	PNSNode * node = TT + (hash % maxnodes);
 
-	if(node->hash != hash){
+	if(!tt_hit(node, hash, board, transform, move)){
 		int outcome, pd;
 
 		if(ab){
@@ -5,6 +5,7 @@
 
 #include "solver.h"
 #include "zobrist.h"
+#include "positioncode.h"
 
 
 class SolverPNSTT : public Solver {
@@ -48,13 +49,16 @@ public:
 
 	PNSNode root;
 	PNSNode * TT;
+	uint32_t * TTcheck; //fingerprint of the exact position in each TT slot, only allocated when verifying
 	uint64_t maxnodes, memlimit;
+	uint64_t collisions; //hash matches with a different position, found by verify
 
 	int   ab; // how deep of an alpha-beta search to run at each leaf node
 	bool  df; // go depth first?
 	float epsilon; //if depth first, how wide should the threshold be?
 	int   ties;    //which player to assign ties to: 0 handle ties, 1 assign p1, 2 assign p2
 	int   copyproof; //how many siblings to try to copy a proof to
+	bool  verify;    //check TT hits against a fingerprint of the position, to catch hash collisions
 
 
 	SolverPNSTT() {
@@ -63,24 +67,24 @@ public:
 		epsilon = 0.25;
 		ties = 0;
 		copyproof = 0;
+		verify = false;
 
 		TT = NULL;
+		TTcheck = NULL;
 		reset();
 
 		set_memlimit(100*1024*1024);
 	}
 
 	~SolverPNSTT(){
-		if(TT){
-			delete[] TT;
-			TT = NULL;
-		}
+		clear_mem();
 	}
 
 	void reset(){
 		outcome = -3;
 		maxdepth = 0;
 		nodes_seen = 0;
+		collisions = 0;
 		time_used = 0;
 		bestmove = Move(M_UNKNOWN);
 
@@ -102,7 +106,7 @@ public:
 	}
 	void set_memlimit(uint64_t lim){
 		memlimit = lim;
-		maxnodes = memlimit/sizeof(PNSNode);
+		maxnodes = memlimit/(sizeof(PNSNode) + (verify ? sizeof(uint32_t) : 0));
 		clear_mem();
 	}
 
@@ -112,20 +116,31 @@ public:
 			delete[] TT;
 			TT = NULL;
 		}
+		if(TTcheck){
+			delete[] TTcheck;
+			TTcheck = NULL;
+		}
+	}
+
+	void set_verify(bool v){
+		verify = v;
+		set_memlimit(memlimit);
 	}
 
 	void solve(double time);
 
 //basic proof number search building a tree
 	void run_pns();
-	void pns(const Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td);
+	void pns(Board & board, PNSNode * node, int depth, uint32_t tp, uint32_t td);
 
 	void copy_proof(const Board & source, const Board & dest, Move smove, Move dmove);
+	void copy_proof_siblings(Board & board, const Move & move1);
 
 //update the phi and delta for the node
 	bool updatePDnum(const Board & board, PNSNode * node = NULL);
 
 	PNSNode * tt(const Board & board);
 	PNSNode * tt(const Board & board, Move move);
+	bool tt_hit(PNSNode * node, hash_t hash, const Board & board, int transform, Move move = M_NONE);
 };
 
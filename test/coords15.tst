@@ -0,0 +1,12 @@
+boardsize 15
+play w ac29
+play b aa13
+10 history
+#? [ac29 aa13]
+gridcoords
+20 history
+#? [ac15 aa1]
+play w ab16
+30 history
+#? [ac15 aa1 ab16]
+quit
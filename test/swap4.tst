@@ -0,0 +1,12 @@
+time -g 0 -r 0 -m 0 -i 20000
+boardsize 4
+swap 1
+player_params -p 1 -g 2 -w 3
+genmove w
+undo
+play w a1
+genmove b
+genmove w
+10 havannah_winner
+#? [none]
+quit
@@ -3,6 +3,7 @@
 
 #include <time.h>
 #include <sys/time.h>
+#include <stdint.h>
 
 class Time {
 	double t;
@@ -36,3 +37,16 @@ public:
 	bool operator != (const Time & a) const { return t != a.t; }
 };
 
+//the cpu's timestamp counter, a few ns to read where Time() is a system call
+//it ticks at a fixed rate close to the nominal clock, so it's for comparing costs, not for wall time
+inline uint64_t rdtsc(){
+#if defined(__i386__) || defined(__x86_64__)
+	uint32_t lo, hi;
+	__asm__ __volatile__ ("rdtsc" : "=a"(lo), "=d"(hi));
+	return ((uint64_t)hi << 32) | lo;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec*1000000000 + ts.tv_nsec;
+#endif
+}
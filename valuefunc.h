@@ -0,0 +1,154 @@
+
+#pragma once
+
+/*
+A linear model of the chance that the side to move wins, a leaf evaluation that can stand in for rollouts.
+
+Every feature is a count, and the value is the logistic of the sum of the counts times their weights:
+- each empty cell adds its local pattern as the side to move sees it, folded by symmetry like the gammas
+- the most corners and the most edges any one group of each side touches
+- the fewest stones each side needs for a non-ring win, from LBDists, only computed if those weights are used
+- a bias
+
+The weights come from logistic regression on self-play positions, see valueinput.rb and valuetrain.cpp
+*/
+
+#include <cmath>
+#include <fstream>
+#include "board.h"
+#include "lbdist.h"
+#include "string.h"
+
+class ValueFunc {
+public:
+	//feature layout, mine then theirs for the per side features
+	enum {
+		F_PATTERN = 0,    //4096, the pattern representative
+		F_CORNERS = 4096, //2*7
+		F_EDGES   = 4110, //2*7
+		F_DISTS   = 4124, //2*16, capped at 15
+		F_BIAS    = 4156,
+		F_NUM     = 4157,
+	};
+
+private:
+	float weights[F_NUM];
+	float patterns[2][4096]; //weight of each raw pattern, already inverted for the side to move and folded by symmetry
+	bool  usedists;
+	bool  loaded;
+
+	//the per side features of a position that aren't patterns
+	void side_features(const Board & board, LBDists & dists, int turn, bool withdists, int corners[2], int edges[2], int mindist[2]) const {
+		corners[0] = corners[1] = edges[0] = edges[1] = 0;
+		mindist[0] = mindist[1] = 15;
+		for(int y = 0; y < board.get_size_d(); y++){
+			for(int x = board.linestart(y); x < board.lineend(y); x++){
+				int i = board.xy(x, y);
+				int p = board.get(i);
+				if(p == 0 || board.find_group(i) != i) //only look at each group once, at its root
+					continue;
+				const Board::Cell * c = board.cell(i);
+				int s = (p != turn);
+				corners[s] = max(corners[s], c->numcorners());
+				edges[s]   = max(edges[s],   c->numedges());
+			}
+		}
+
+		if(withdists){
+			dists.run(&board);
+			mindist[0] = min(15, dists.mindist(turn));
+			mindist[1] = min(15, dists.mindist(3 - turn));
+		}
+	}
+
+public:
+	ValueFunc() { clear(); }
+
+	void clear(){
+		for(int i = 0; i < F_NUM; i++)
+			weights[i] = 0;
+		for(int i = 0; i < 4096; i++)
+			patterns[0][i] = patterns[1][i] = 0;
+		usedists = false;
+		loaded = false;
+	}
+
+	bool is_loaded() const { return loaded; }
+
+	//read "index weight" lines, any feature left out has weight 0. Returns an error message, empty on success
+	string load(const string & filename){
+		ifstream ifs(filename.c_str());
+		if(!ifs.good())
+			return "Failed to open file for reading";
+
+		clear();
+
+		int i;
+		float w;
+		while(ifs >> i >> w){
+			if(i < 0 || i >= F_NUM){
+				clear();
+				return "Feature " + to_str(i) + " is out of range";
+			}
+			weights[i] = w;
+		}
+
+		//a pattern from black's point of view is the inverted pattern from white's
+		for(int p = 0; p < 4096; p++){
+			patterns[0][p] = weights[F_PATTERN + Board::pattern_symmetry(p)];
+			patterns[1][p] = weights[F_PATTERN + Board::pattern_symmetry(Board::pattern_invert(p))];
+		}
+
+		for(int d = 0; d < 32; d++)
+			usedists |= (weights[F_DISTS + d] != 0);
+
+		loaded = true;
+		return "";
+	}
+
+	//the feature indexes of a position, repeated once per count, for writing training data
+	vector<int> features(const Board & board, LBDists & dists) const {
+		vector<int> ret;
+		int turn = board.toplay();
+
+		for(Board::MoveIterator m = board.moveit(NULL, false); !m.done(); ++m){
+			unsigned int p = board.pattern(*m);
+			if(turn == 2)
+				p = Board::pattern_invert(p);
+			ret.push_back(F_PATTERN + Board::pattern_symmetry(p));
+		}
+
+		int corners[2], edges[2], mindist[2];
+		side_features(board, dists, turn, true, corners, edges, mindist); //training data always has the distances
+
+		for(int s = 0; s < 2; s++){
+			ret.push_back(F_CORNERS + 7*s + corners[s]);
+			ret.push_back(F_EDGES   + 7*s + edges[s]);
+			ret.push_back(F_DISTS   + 16*s + mindist[s]);
+		}
+		ret.push_back(F_BIAS);
+		return ret;
+	}
+
+	//the chance that the side to move wins, O(cells), plus an LBDists run if the distance weights are used
+	float eval(const Board & board, LBDists & dists) const {
+		int turn = board.toplay();
+		const float * pat = patterns[turn-1];
+
+		float sum = weights[F_BIAS];
+		for(Board::MoveIterator m = board.moveit(NULL, false); !m.done(); ++m)
+			sum += pat[board.pattern(*m)];
+
+		int corners[2], edges[2], mindist[2];
+		side_features(board, dists, turn, usedists, corners, edges, mindist);
+		for(int s = 0; s < 2; s++){
+			sum += weights[F_CORNERS + 7*s + corners[s]];
+			sum += weights[F_EDGES   + 7*s + edges[s]];
+			if(usedists)
+				sum += weights[F_DISTS + 16*s + mindist[s]];
+		}
+
+		return 1.0f/(1.0f + std::exp(-sum));
+	}
+};
+
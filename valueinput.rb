@@ -0,0 +1,55 @@
+#!/usr/bin/ruby
+
+# turn a list of games into training data for valuetrain
+# usage: ./valueinput.rb [size] <games.txt >input.dat
+# each line of games.txt is the moves of one finished game, each line of output is
+# whether the side to move went on to win, then the features of that position
+
+class GTPClient
+	def initialize(cmdline, newline = "\n")
+		@io=IO.popen(cmdline,'w+')
+		@sep = newline + newline
+	end
+	def cmd(c)
+		return [true, ""] if c.strip == ""
+		@io.puts c.strip
+		res = @io.gets(@sep).strip.split(' ', 2)
+		res[0] = (res[0] == '=')
+		return res
+	end
+	def close
+		@io.close
+	end
+end
+
+size = (ARGV[0] || 5).to_i
+
+gtp = GTPClient.new("./castro")
+
+linenum = 0;
+prefix = $0;
+
+$stdin.each_line {|line|
+	$0 = "#{prefix} - #{linenum}"
+	linenum += 1;
+
+	moves = line.strip.split
+
+	gtp.cmd("boardsize #{size}")
+	gtp.cmd("playgame #{moves.join ' '}")
+	winner = gtp.cmd("winner")[1].to_s.strip
+	next if winner != "white" && winner != "black"
+
+	gtp.cmd("boardsize #{size}")
+	moves.each_with_index{|move, i|
+		toplay = (i % 2 == 0 ? "white" : "black")
+		features = gtp.cmd("features")[1].split("\n")[0]
+		puts "#{toplay == winner ? 1 : 0} #{features}"
+
+		gtp.cmd("playgame #{move}")
+	}
+}
+
+gtp.cmd("quit")
+gtp.close
+
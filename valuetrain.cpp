@@ -0,0 +1,84 @@
+
+//Fit the weights of the value function by logistic regression, see valuefunc.h
+//usage: ./valuetrain [epochs] [rate] [l2] <input.dat >weights.dat
+//each line of input.dat is the outcome for the side to move, 1 for a win and 0 for a loss,
+//then the feature indexes as output by the features gtp command, see valueinput.rb
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+struct Sample {
+	float outcome;
+	vector<int> features; //repeated once per count
+};
+
+int main(int argc, char ** argv){
+	int    epochs = (argc > 1 ? atoi(argv[1]) : 20);
+	double rate   = (argc > 2 ? atof(argv[2]) : 0.001);
+	double l2     = (argc > 3 ? atof(argv[3]) : 0.0001);
+
+	vector<Sample> samples;
+	int numfeatures = 0;
+
+	string line;
+	while(getline(cin, line)){
+		istringstream in(line);
+		Sample s;
+		int f;
+		if(!(in >> s.outcome))
+			continue;
+		while(in >> f){
+			s.features.push_back(f);
+			numfeatures = max(numfeatures, f+1);
+		}
+		samples.push_back(s);
+	}
+
+	if(samples.empty()){
+		cerr << "No samples\n";
+		return 1;
+	}
+
+	vector<double> w(numfeatures, 0);
+	vector<int> order(samples.size());
+	for(unsigned int i = 0; i < order.size(); i++)
+		order[i] = i;
+
+	for(int e = 0; e < epochs; e++){
+		random_shuffle(order.begin(), order.end());
+
+		double loss = 0;
+		for(unsigned int k = 0; k < order.size(); k++){
+			const Sample & s = samples[order[k]];
+
+			double sum = 0;
+			for(unsigned int i = 0; i < s.features.size(); i++)
+				sum += w[s.features[i]];
+
+			double p = 1/(1 + exp(-sum));
+			loss -= (s.outcome > 0.5 ? log(p + 1e-12) : log(1 - p + 1e-12));
+
+			//the weights that aren't in this sample skip their decay, which is fine for sparse features
+			double g = rate*(s.outcome - p);
+			for(unsigned int i = 0; i < s.features.size(); i++){
+				double & x = w[s.features[i]];
+				x += g - rate*l2*x;
+			}
+		}
+		cerr << "epoch " << e+1 << ": log loss " << loss/samples.size() << "\n";
+	}
+
+	for(int i = 0; i < numfeatures; i++)
+		if(w[i] != 0)
+			printf("%d %.6f\n", i, w[i]);
+
+	return 0;
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+/*
+Given weights for indexes, returns a random index according to the weights.
+A drop in replacement for WeightedRandTree with O(1) updates and expected O(1) choose.
+
+Weights are quantised to integers and each index is kept in the bucket for its highest bit,
+so every weight in bucket b is in [2^b, 2^(b+1)). Choosing picks a bucket by its exact integer sum,
+then an index in it uniformly, accepting it with probability weight/2^(b+1), which is at least 1/2.
+Any positive weight counts, no matter how small, and there are at most 32 buckets to look at.
+*/
+
+#include <stdint.h>
+#include "xorshift.h"
+
+class WeightedRandBuckets {
+	static const int numbuckets = 32;
+	static const int scale = 65536; //quantisation, weights are stored as round(weight*scale)
+
+	mutable XORShift_uint64 rand64;
+	unsigned int size, allocsize;
+	uint32_t * weights; //quantised weight per index, 0 if it can't be chosen
+	uint16_t * where;   //position of each index in its bucket's list
+	uint16_t * lists;   //bucket b's indexes are lists[b*size] to lists[b*size + count[b] - 1]
+	unsigned int count[numbuckets];
+	uint64_t sums[numbuckets];
+	uint64_t total;
+	uint32_t nonempty; //bit b is set if bucket b has any indexes
+
+	static uint32_t quantise(float w){
+		if(w <= 0)
+			return 0;
+		float q = w*scale + 0.5f;
+		if(q < 1)
+			return 1;
+		if(q >= 2147483648.0f)
+			return 2147483647;
+		return (uint32_t)q;
+	}
+	static int bucket(uint32_t q){
+		return 31 - __builtin_clz(q);
+	}
+
+	void add(unsigned int i, uint32_t q){
+		int b = bucket(q);
+		where[i] = count[b];
+		lists[b*size + count[b]++] = i;
+		sums[b] += q;
+		total += q;
+		nonempty |= (1u << b);
+	}
+	void remove(unsigned int i, uint32_t q){
+		int b = bucket(q);
+		unsigned int last = lists[b*size + --count[b]];
+		lists[b*size + where[i]] = last;
+		where[last] = where[i];
+		sums[b] -= q;
+		total -= q;
+		if(count[b] == 0)
+			nonempty &= ~(1u << b);
+	}
+
+	WeightedRandBuckets(const WeightedRandBuckets &); //use copy_weights
+	WeightedRandBuckets & operator=(const WeightedRandBuckets &);
+
+public:
+	WeightedRandBuckets()      : size(0), allocsize(0), weights(NULL), where(NULL), lists(NULL) { }
+	WeightedRandBuckets(unsigned int s) : allocsize(0), weights(NULL), where(NULL), lists(NULL) { resize(s); }
+
+	~WeightedRandBuckets(){
+		if(weights){
+			delete[] weights;
+			delete[] where;
+			delete[] lists;
+		}
+		weights = NULL;
+	}
+
+	//resize and clear, indexes must fit in 16 bits
+	void resize(unsigned int s){
+		size = s;
+
+		if(size > allocsize){
+			if(weights){
+				delete[] weights;
+				delete[] where;
+				delete[] lists;
+			}
+
+			allocsize = size;
+			weights = new uint32_t[size];
+			where   = new uint16_t[size];
+			lists   = new uint16_t[size*numbuckets];
+		}
+
+		clear();
+	}
+
+	//reset all weights to 0, O(s)
+	void clear(){
+		for(unsigned int i = 0; i < size; i++)
+			weights[i] = 0;
+		for(int b = 0; b < numbuckets; b++){
+			count[b] = 0;
+			sums[b] = 0;
+		}
+		total = 0;
+		nonempty = 0;
+	}
+
+	//take the weights of another sampler, keeping this one's random state, O(s)
+	void copy_weights(const WeightedRandBuckets & o){
+		if(size != o.size)
+			resize(o.size);
+		for(unsigned int i = 0; i < size; i++){
+			weights[i] = o.weights[i];
+			where[i] = o.where[i];
+		}
+		for(int b = 0; b < numbuckets; b++){
+			count[b] = o.count[b];
+			sums[b] = o.sums[b];
+			for(unsigned int j = 0; j < count[b]; j++)
+				lists[b*size + j] = o.lists[b*size + j];
+		}
+		total = o.total;
+		nonempty = o.nonempty;
+	}
+
+	//get an individual weight, after quantisation, O(1)
+	float get_weight(unsigned int i) const {
+		return (float)weights[i] / scale;
+	}
+
+	//get the sum of the weights, O(1)
+	float sum_weight() const {
+		return (float)total / scale;
+	}
+
+	//nothing to rebuild, the sums are always up to date. Here so it can stand in for WeightedRandTree
+	void rebuild_tree(){ }
+
+	//same as set_weight, O(1)
+	void set_weight_fast(unsigned int i, float w){
+		set_weight(i, w);
+	}
+
+	//sets the weight and moves it to its new bucket, O(1)
+	void set_weight(unsigned int i, float w){
+		uint32_t q = quantise(w);
+		if(weights[i] == q)
+			return;
+
+		if(weights[i])
+			remove(i, weights[i]);
+		if(q)
+			add(i, q);
+		weights[i] = q;
+	}
+
+	//return a weighted random index, expected O(1), -1 if all weights are 0
+	unsigned int choose() const {
+		if(total == 0)
+			return -1;
+
+		uint64_t r = (uint64_t)(((unsigned __int128)rand64() * total) >> 64); //uniform in [0, total) without a division
+		int b;
+		uint32_t m = nonempty;
+		while(true){ //heaviest buckets first, they're the most likely
+			b = 31 - __builtin_clz(m);
+			if(r < sums[b])
+				break;
+			r -= sums[b];
+			m &= ~(1u << b);
+		}
+
+		const uint16_t * list = lists + b*size;
+		uint64_t n = count[b];
+		while(true){
+			uint64_t x = rand64();
+			unsigned int i = list[((x & 0xFFFFFFFF) * n) >> 32];
+			if((x >> (63 - b)) < weights[i]) //uniform in [0, 2^(b+1))
+				return i;
+		}
+	}
+};
+
@@ -54,6 +54,14 @@ public:
 		clear();
 	}
 
+	//take the weights of another tree, keeping this one's random state, O(s)
+	void copy_weights(const WeightedRandTree & o){
+		if(size != o.size)
+			resize(o.size);
+		for(unsigned int i = 0; i < size*2; i++)
+			weights[i] = o.weights[i];
+	}
+
 	//reset all weights to 0, O(s)
 	void clear(){
 		for(unsigned int i = 0; i < size*2; i++)
@@ -40,5 +40,14 @@ public:
 				m = values[i];
 		return m;
 	}
+
+	//the minimum, and which permutation it came from
+	hash_t get_min(int & permutation) const {
+		permutation = 0;
+		for(int i = 1; i < 12; i++)
+			if(values[permutation] > values[i])
+				permutation = i;
+		return values[permutation];
+	}
 };
 